@@ -0,0 +1,6 @@
+#pragma once
+
+// _LOWER and _RAISE together turn on _ADJUST.
+#define TRI_LAYER_LOWER_LAYER 1
+#define TRI_LAYER_UPPER_LAYER 3
+#define TRI_LAYER_ADJUST_LAYER 5
@@ -3,7 +3,7 @@
 
 #include QMK_KEYBOARD_H
 
-#include "features/achordion.h"
+#include "seruman.h"
 
 enum layer_names {
   _BASE,
@@ -19,23 +19,6 @@ enum tap_dance_codes {
   TD_RAISE,
 };
 
-typedef struct {
-  bool is_press_action;
-  int state;
-} xtap;
-
-enum {
-  SINGLE_TAP = 1,
-  SINGLE_HOLD = 2,
-  DOUBLE_TAP = 3,
-  DOUBLE_HOLD = 4,
-  DOUBLE_SINGLE_TAP = 5, // send two single taps
-  TRIPLE_TAP = 6,
-  TRIPLE_HOLD = 7,
-  UNKNOWN = 99
-
-};
-
 #define LOWER TD(TD_LOWER)
 #define RAISE TD(TD_RAISE)
 #define ADJUST MO(_ADJUST)
@@ -220,145 +203,35 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
      *                     └───┘    └───┘
      *
      */
-    [_ADJUST] = LAYOUT_split_3x5_3(
+    [_ADJUST] = WRAP(LAYOUT_split_3x5_3,
         _______, _______, _______, _______, _______,                            _______, _______, _______, _______, _______,
-        _______, _______, _______, _______, _______,                            _______, KC_VOLD, KC_MUTE, KC_VOLU, _______,
-        _______, _______, _______, _______, _______,                            _______, KC_MPRV, KC_MPLY, KC_MNXT, _______,
+        _______, _______, _______, _______, _______,                            _______, ___MEDIA_VOLUME___,        _______,
+        _______, _______, _______, _______, _______,                            _______, ___MEDIA_TRACK____,        _______,
                                    _______, _______, _______,          _______, _______, _______
     )
 };
 // clang-format on
 
-layer_state_t layer_state_set_user(layer_state_t state) {
-  return update_tri_layer_state(state, _LOWER, _RAISE, _ADJUST);
-}
-
-int cur_dance(tap_dance_state_t *state) {
-  if (state->count == 1) {
-    // If count = 1, and it has been interrupted - it doesn't matter if it is
-    // pressed or not: Send SINGLE_TAP
-    if (state->interrupted) {
-      //     if (!state->pressed) return SINGLE_TAP;
-      // need "permissive hold" here.
-      //     else return SINsGLE_HOLD;
-      // If the interrupting key is released before the tap-dance key, then it
-      // is a single HOLD However, if the tap-dance key is released first, then
-      // it is a single TAP But how to get access to the state of the
-      // interrupting key????
-      return SINGLE_TAP;
-    } else {
-      if (!state->pressed)
-        return SINGLE_TAP;
-      else
-        return SINGLE_HOLD;
-    }
-  }
-  // If count = 2, and it has been interrupted - assume that user is trying to
-  // type the letter associated with single tap.
-  else if (state->count == 2) {
-    if (state->interrupted)
-      return DOUBLE_SINGLE_TAP;
-    else if (state->pressed)
-      return DOUBLE_HOLD;
-    else
-      return DOUBLE_TAP;
-  } else if ((state->count == 2) && ((state->interrupted) || (!state->pressed)))
-    return TRIPLE_TAP;
-  else if ((state->count == 3) && ((state->interrupted) || (!state->pressed)))
-    return TRIPLE_TAP;
-  else if (state->count == 3)
-    return TRIPLE_HOLD;
-  else
-    return UNKNOWN;
-}
-
-static xtap tap_lower_state = {.is_press_action = true, .state = 0};
-
-void tap_lower_finished(tap_dance_state_t *state, void *user_data) {
-  tap_lower_state.state = cur_dance(state);
-  // single tap hold to switch lower, double hold to switch double LOWER
-  switch (tap_lower_state.state) {
-  case SINGLE_TAP:
-    layer_on(_LOWER);
-    break;
-  case SINGLE_HOLD:
-    layer_on(_LOWER);
-    break;
-  case DOUBLE_HOLD:
-    layer_on(_DOUBLE_LOWER);
-    break;
-  }
-}
-
-void tap_lower_reset(tap_dance_state_t *state, void *user_data) {
-  switch (tap_lower_state.state) {
-  case SINGLE_TAP:
-    layer_off(_LOWER);
-    break;
-  case SINGLE_HOLD:
-    layer_off(_LOWER);
-    break;
-  case DOUBLE_HOLD:
-    layer_off(_DOUBLE_LOWER);
-    break;
-  }
-  tap_lower_state.state = 0;
-}
-
-static xtap tap_raise_state = {.is_press_action = true, .state = 0};
-
-void tap_raise_finished(tap_dance_state_t *state, void *user_data) {
-  tap_raise_state.state = cur_dance(state);
-  // single tap hold to switch raise, double hold to switch double raise
-  switch (tap_raise_state.state) {
-  case SINGLE_TAP:
-    layer_on(_RAISE);
-    break;
-  case SINGLE_HOLD:
-    layer_on(_RAISE);
-    break;
-  case DOUBLE_HOLD:
-    layer_on(_DOUBLE_RAISE);
-    break;
-  }
-}
+// Single tap or hold to switch to a layer, double hold to switch to its
+// double layer.
+static const uint8_t PROGMEM lower_layers[DANCE_OUTCOMES] = {
+    [DANCE_TAP] = _LOWER,
+    [DANCE_HOLD] = _LOWER,
+    [DANCE_DOUBLE_HOLD] = _DOUBLE_LOWER,
+};
 
-void tap_raise_reset(tap_dance_state_t *state, void *user_data) {
-  switch (tap_raise_state.state) {
-  case SINGLE_TAP:
-    layer_off(_RAISE);
-    break;
-  case SINGLE_HOLD:
-    layer_off(_RAISE);
-    break;
-  case DOUBLE_HOLD:
-    layer_off(_DOUBLE_RAISE);
-    break;
-  }
-  tap_raise_state.state = 0;
-}
+static const uint8_t PROGMEM raise_layers[DANCE_OUTCOMES] = {
+    [DANCE_TAP] = _RAISE,
+    [DANCE_HOLD] = _RAISE,
+    [DANCE_DOUBLE_HOLD] = _DOUBLE_RAISE,
+};
 
 // Tap Dance Definitions
 tap_dance_action_t tap_dance_actions[] = {
-    [TD_LOWER] =
-        ACTION_TAP_DANCE_FN_ADVANCED(NULL, tap_lower_finished, tap_lower_reset),
-    [TD_RAISE] =
-        ACTION_TAP_DANCE_FN_ADVANCED(NULL, tap_raise_finished, tap_raise_reset),
+    [TD_LOWER] = ACTION_TAP_DANCE_LAYERS(lower_layers),
+    [TD_RAISE] = ACTION_TAP_DANCE_LAYERS(raise_layers),
 };
 
-uint16_t achordion_timeout(uint16_t tap_hold_keycode) { return 600; }
-
-bool process_record_user(uint16_t keycode, keyrecord_t *record) {
-  if (!process_achordion(keycode, record)) {
-    return false;
-  }
-  // Your macros ...
-
-  return true;
-}
-
-void matrix_scan_user(void) { achordion_task(); }
-
 /* #define Z_LSFT LSFT_T(KC_Z) */
 /* #define SLSH_RSFT RSFT_T(KC_SLSH) */
 /* #define EQL_LSFT LSFT_T(KC_EQL) */
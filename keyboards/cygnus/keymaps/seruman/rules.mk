@@ -0,0 +1,5 @@
+CHORDAL_HOLD_ENABLE = yes
+TRI_LAYER_STATE_ENABLE = yes
+LAYER_DANCE_ENABLE = yes
+HOOK_TIMING_ENABLE = no
+ADAPTIVE_TERM_ENABLE = no
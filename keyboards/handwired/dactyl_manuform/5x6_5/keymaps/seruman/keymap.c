@@ -15,6 +15,8 @@
 
 #include QMK_KEYBOARD_H
 
+#include "seruman.h"
+
 #define CM_SPAL  LGUI_T(KC_SPC)
 #define CM_SPAR  RGUI_T(KC_SPC)
 
@@ -115,7 +117,7 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
                      _______, _______,          _______, _______, _______, _______, _______, _______,          _______, _______,
                                                          _______, _______, _______, _______
    ),
-  [_ADJUST] = LAYOUT_5x6_5(
+  [_ADJUST] = WRAP(LAYOUT_5x6_5,
   /* ADJUST
    * .-----------------------------------------.                                  .-----------------------------------------.
    * |  RST |      |      |      |      | QWERT|                                  |      |      |      |      |      | RST  |
@@ -136,8 +138,8 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
    */
    QK_BOOT, XXXXXXX, XXXXXXX, XXXXXXX, XXXXXXX, QWERT  ,                                     XXXXXXX, XXXXXXX, XXXXXXX, XXXXXXX, XXXXXXX, QK_BOOT,
    XXXXXXX, XXXXXXX, XXXXXXX, XXXXXXX, XXXXXXX, XXXXXXX,                                     XXXXXXX, XXXXXXX, XXXXXXX, XXXXXXX, XXXXXXX, XXXXXXX,
-   XXXXXXX, XXXXXXX, XXXXXXX, XXXXXXX, XXXXXXX, XXXXXXX,                                     XXXXXXX, KC_VOLD, KC_MUTE, KC_VOLU, XXXXXXX, XXXXXXX,
-   XXXXXXX, XXXXXXX, XXXXXXX, XXXXXXX, XXXXXXX, XXXXXXX,                                     XXXXXXX, KC_MPRV, KC_MPLY, KC_MNXT, XXXXXXX, XXXXXXX,
+   XXXXXXX, XXXXXXX, XXXXXXX, XXXXXXX, XXXXXXX, XXXXXXX,                                     XXXXXXX, ___MEDIA_VOLUME___,        XXXXXXX, XXXXXXX,
+   XXXXXXX, XXXXXXX, XXXXXXX, XXXXXXX, XXXXXXX, XXXXXXX,                                     XXXXXXX, ___MEDIA_TRACK____,        XXXXXXX, XXXXXXX,
                      _______, XXXXXXX,          XXXXXXX, XXXXXXX, XXXXXXX, XXXXXXX, XXXXXXX, XXXXXXX,          XXXXXXX, _______,
                                                          XXXXXXX, XXXXXXX, XXXXXXX, XXXXXXX
    )
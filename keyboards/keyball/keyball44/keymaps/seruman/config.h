@@ -40,7 +40,6 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #define TAPPING_TERM 190
 #define FLOW_TAP_TERM 150
-#define CHORDAL_HOLD
 #define PERMISSIVE_HOLD
 #define TAPPING_TERM_PER_KEY
 
@@ -53,3 +52,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define KEYBALL_SCROLLSNAP_ENABLE 0
 
 #define KEYBALL_REPORTMOUSE_INTERVAL 4
+
+// Scroll in 1/120 detent steps. Only for hosts that apply the HID Resolution
+// Multiplier (Linux, Windows); others scroll 120 times faster. 16-bit wheel
+// fields leave room for fast scrolling at that resolution.
+#define POINTING_DEVICE_HIRES_SCROLL_ENABLE
+#define WHEEL_EXTENDED_REPORT
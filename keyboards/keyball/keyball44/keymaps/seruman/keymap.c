@@ -21,23 +21,16 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "quantum.h"
 #include "raw_hid.h"
 
-// clang-format off
-const char chordal_hold_layout[MATRIX_ROWS][MATRIX_COLS] PROGMEM =
-    LAYOUT_universal(
-        'L', 'L', 'L', 'L', 'L', 'L',                     'R', 'R', 'R', 'R', 'R', 'R',
-        'L', 'L', 'L', 'L', 'L', 'L',                     'R', 'R', 'R', 'R', 'R', 'R',
-        'L', 'L', 'L', 'L', 'L', 'L',                     'R', 'R', 'R', 'R', 'R', 'R',
-                   'L', 'L', 'L', 'L', 'L',      'R', 'R', 'R', 'R', 'R'
-    );
+#include "seruman.h"
+
+#include "motion.h"
 
 enum custom_keycodes {
     KC_FAVTRK = SAFE_RANGE,
     KC_WINHNT,
 };
 
-#define LGA_T(kc) MT(MOD_LGUI | MOD_LALT, kc)
-#define RGA_T(kc) MT(MOD_RGUI | MOD_RALT, kc)
-
+// clang-format off
 const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
     // Layer 0: Base layer (QWERTY)
     [0] = LAYOUT_universal(
@@ -80,9 +73,9 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
     ),
 
     // Layer 5: Media, miscellaneous.
-    [5] = LAYOUT_universal(
-        G(C(KC_Q)),     _______,  _______,  _______,      _______,      _______,                                   _______,  KC_VOLD,      KC_MUTE,      KC_VOLU,  _______,  _______,
-        _______,        _______,  _______,  _______,      KC_WINHNT,    _______,                                   _______,  KC_MPRV,      KC_MPLY,      KC_MNXT,  _______,  _______,
+    [5] = WRAP(LAYOUT_universal,
+        G(C(KC_Q)),     _______,  _______,  _______,      _______,      _______,                                   _______,  ___MEDIA_VOLUME___,                   _______,  _______,
+        _______,        _______,  _______,  _______,      KC_WINHNT,    _______,                                   _______,  ___MEDIA_TRACK____,                   _______,  _______,
         _______,        _______,  _______,  _______,      _______,      _______,                                   _______,  KC_FAVTRK,    _______,      _______,  _______,  _______,
                                   _______,  _______,      _______,      _______,   _______,              _______,  _______,  _______,      _______,      _______
     ),
@@ -90,51 +83,63 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
 // clang-format on
 //
 
-typedef enum {
-    HID_CMD_LAYER_STATUS   = 0x01,
-    HID_CMD_FAVORITE_TRACK = 0x02,
-    HID_CMD_WINDOW_HINTS   = 0x03,
-} hid_command_t;
-
-static void send_hid_command(hid_command_t cmd, uint8_t data_byte) {
-    uint8_t data[32];
-    memset(data, 0, 32);
-    data[0] = cmd;
-    if (data_byte != 0) {
-        data[1] = data_byte;
-    }
-    raw_hid_send(data, 32);
+#define STATE_REPORT_VERSION 1
+// Changes within this window are merged into a single state report.
+#define STATE_REPORT_INTERVAL_MS 1
+
+// State payload, version 1:
+//   [0] version            [1] highest layer  [2] mods          [3..6] layer state (LE)
+//   [7] CPI / 100          [8] scroll mode    [9] scroll divider
+#define STATE_PAYLOAD_SIZE 10
+
+static void fill_state_payload(uint8_t* payload) {
+    payload[0] = STATE_REPORT_VERSION;
+    payload[1] = get_highest_layer(layer_state);
+    payload[2] = get_mods();
+    hid_put_u32(&payload[3], (uint32_t)layer_state);
+    payload[7] = keyball_get_cpi();
+    payload[8] = keyball_get_scroll_mode();
+    payload[9] = keyball_get_scroll_div();
 }
 
-static void send_layer_status(uint8_t layer, layer_state_t state) {
-    uint8_t data[32];
-    memset(data, 0, 32);
-    data[0] = HID_CMD_LAYER_STATUS;
-    data[1] = layer;
-    data[2] = (uint8_t)(state & 0xFF);
-    data[3] = (uint8_t)((state >> 8) & 0xFF);
-    raw_hid_send(data, 32);
+// State report: [0] HID_CMD_STATE_REPORT, [1..] state payload.
+static void send_state_report(void) {
+    uint8_t data[HID_REPORT_SIZE];
+    memset(data, 0, HID_REPORT_SIZE);
+    data[0] = HID_CMD_STATE_REPORT;
+    fill_state_payload(&data[1]);
+    raw_hid_send(data, HID_REPORT_SIZE);
 }
 
-bool get_chordal_hold(uint16_t tap_hold_keycode, keyrecord_t* tap_hold_record, uint16_t other_keycode, keyrecord_t* other_record) {
-    if (tap_hold_keycode == LCTL_T(KC_TAB)) {
-        // Hold for all keys as it is very high change that what I want is
-        // <C-<other_keycode>>.
-        return true;
-    }
+static deferred_token state_report_token = INVALID_DEFERRED_TOKEN;
 
-    if (tap_hold_keycode == RCTL_T(KC_QUOT)) {
-        switch (other_keycode) {
-            case KC_B: // <C-b> ghostty prefix.
-            case KC_C: // <C-c>
-                return true;
-        }
+static uint32_t flush_state_report(uint32_t trigger_time, void* cb_arg) {
+    state_report_token = INVALID_DEFERRED_TOKEN;
+    send_state_report();
+    return 0;
+}
+
+// Schedules a state report instead of sending one per change, so a tri-layer
+// roll that flips several layers in one scan reaches the host as one report
+// carrying the final state. Modifiers ride along but do not trigger a report,
+// or home row mods would send one on most keystrokes.
+static void state_report_changed(void) {
+    if (state_report_token != INVALID_DEFERRED_TOKEN) {
+        return;
     }
 
-    return get_chordal_hold_default(tap_hold_record, other_record);
+    state_report_token = defer_exec(STATE_REPORT_INTERVAL_MS, flush_state_report, NULL);
+    if (state_report_token == INVALID_DEFERRED_TOKEN) {
+        send_state_report();
+    }
 }
 
-uint16_t get_tapping_term(uint16_t keycode, keyrecord_t* record) {
+// Hold for all keys as it is very high change that what I want is
+// <C-<other_keycode>>. RCTL_T(KC_QUOT) with <C-b> (ghostty prefix) and <C-c>
+// needs no entry; those are on the other hand.
+const uint16_t PROGMEM chordal_hold_always[] = {LCTL_T(KC_TAB), KC_NO};
+
+uint16_t get_tapping_term_keymap(uint16_t keycode, keyrecord_t* record) {
     switch (keycode) {
         case LCTL_T(KC_TAB):
         case RCTL_T(KC_QUOT):
@@ -144,36 +149,88 @@ uint16_t get_tapping_term(uint16_t keycode, keyrecord_t* record) {
     return TAPPING_TERM;
 }
 
-bool process_record_user(uint16_t keycode, keyrecord_t* record) {
+bool process_record_keymap(uint16_t keycode, keyrecord_t* record) {
     switch (keycode) {
+        // Handled by the keyball core after us; the report reads the new values.
+        case CPI_I100:
+        case CPI_D100:
+        case CPI_I1K:
+        case CPI_D1K:
+        case SCRL_DVI:
+        case SCRL_DVD:
+        case KBC_RST:
+            if (record->event.pressed) {
+                state_report_changed();
+            }
+            return true;
         case KC_FAVTRK:
             if (record->event.pressed) {
-                send_hid_command(HID_CMD_FAVORITE_TRACK, 0);
+                hid_send_command(HID_CMD_FAVORITE_TRACK, 0);
             }
             return false;
         case KC_WINHNT:
             if (record->event.pressed) {
-                send_hid_command(HID_CMD_WINDOW_HINTS, 0);
+                hid_send_command(HID_CMD_WINDOW_HINTS, 0);
             }
             return false;
     }
     return true;
 }
 
-layer_state_t layer_state_set_user(layer_state_t state) {
+// What KBC_SAVE stores, written directly rather than by replaying the
+// keycode through process_record_kb and the whole user chain. Fields the
+// keymap does not change keep their saved values.
+static void save_pointer_config(void) {
+    keyball_config_t config = {.raw = eeconfig_read_kb()};
+    config.cpi               = keyball.cpi_value;
+    config.sdiv              = keyball.scroll_div;
+    eeconfig_update_kb(config.raw);
+}
+
+hid_status_t hid_request_keymap(const uint8_t* request, uint8_t* payload) {
+    switch (request[0]) {
+        case HID_REQ_GET_STATE:
+            fill_state_payload(payload);
+            return HID_STATUS_OK;
+        case HID_REQ_GET_POINTER:
+            payload[0] = keyball_get_cpi();
+            payload[1] = keyball_get_scroll_div();
+            payload[2] = keyball_get_scroll_mode();
+            return HID_STATUS_OK;
+        case HID_REQ_SET_LAYER:
+            if (request[2] >= sizeof(keymaps) / sizeof(keymaps[0])) {
+                return HID_STATUS_INVALID_ARG;
+            }
+            layer_move(request[2]);
+            fill_state_payload(payload);
+            return HID_STATUS_OK;
+        case HID_REQ_SAVE:
+            save_pointer_config();
+            return HID_STATUS_OK;
+    }
+    return HID_STATUS_UNKNOWN_REQUEST;
+}
+
+layer_state_t layer_state_set_keymap(layer_state_t state) {
     uint8_t current_layer = get_highest_layer(state);
 
     keyball_set_scroll_mode(current_layer == 3);
 
-    send_layer_status(current_layer, state);
+    state_report_changed();
     return state;
 }
 
+report_mouse_t pointing_device_task_user(report_mouse_t report) {
+    return motion_task(report);
+}
+
 #ifdef OLED_ENABLE
 
 #    include "lib/oledkit/oledkit.h"
 
 void oledkit_render_info_user(void) {
+    HOOK_TIMING_SCOPE(HOOK_OLED);
+
     keyball_oled_render_keyinfo();
     keyball_oled_render_ballinfo();
     keyball_oled_render_layerinfo();
@@ -0,0 +1,103 @@
+#include QMK_KEYBOARD_H
+
+#include <stdlib.h>
+
+#include "motion.h"
+
+// Fixed point with 8 fractional bits.
+#define Q8(x) ((int32_t)((x) * 256))
+
+// Speed buckets, in counts per report (|x| + |y|, halved).
+#define ACCEL_BUCKETS 16
+
+// Pointer gain per speed bucket: 0.75 at rest, 1.0 around 5 counts per
+// report, then rising by 0.15 per bucket.
+static const uint16_t PROGMEM accel_gain[ACCEL_BUCKETS] = {
+    Q8(0.75), Q8(0.875), Q8(1.0), Q8(1.125), Q8(1.25), Q8(1.4), Q8(1.55), Q8(1.7),
+    Q8(1.85), Q8(2.0),   Q8(2.15), Q8(2.3),  Q8(2.45), Q8(2.6), Q8(2.75), Q8(2.9),
+};
+
+// Scaled motion not reported yet, in Q8.
+typedef struct {
+    int32_t x;
+    int32_t y;
+} accumulator_t;
+
+static accumulator_t pointer;
+
+// Takes the whole counts out of `acc`, leaving the fraction behind, and
+// clamps them to [lo, hi]. Counts beyond that are dropped.
+static int16_t take(int32_t *acc, int16_t lo, int16_t hi) {
+    int32_t whole = *acc / 256;
+
+    *acc -= whole * 256;
+    return MIN(MAX(whole, lo), hi);
+}
+
+static report_mouse_t accelerate(report_mouse_t report) {
+    uint16_t speed = (abs(report.x) + abs(report.y)) / 2;
+    uint16_t gain  = pgm_read_word(&accel_gain[MIN(speed, ACCEL_BUCKETS - 1)]);
+
+    pointer.x += (int32_t)report.x * gain;
+    pointer.y += (int32_t)report.y * gain;
+    report.x = take(&pointer.x, XY_REPORT_MIN, XY_REPORT_MAX);
+    report.y = take(&pointer.y, XY_REPORT_MIN, XY_REPORT_MAX);
+    return report;
+}
+
+// The keyball core has already turned motion into whole detents, divided by
+// the scroll divider with the remainder kept for the next report.
+static report_mouse_t scroll(report_mouse_t report) {
+    // Left over from pointer mode; it would jump the pointer on the way out.
+    pointer = (accumulator_t){0};
+#ifdef POINTING_DEVICE_HIRES_SCROLL_ENABLE
+    // Wheel units per detent, fixed at build time. Assumes a host that
+    // applies the HID Resolution Multiplier (Linux, Windows); others take
+    // every unit as a detent and scroll this many times faster.
+    int32_t resolution = pointing_device_get_hires_scroll_resolution();
+
+    report.h = MIN(MAX(report.h * resolution, HV_REPORT_MIN), HV_REPORT_MAX);
+    report.v = MIN(MAX(report.v * resolution, HV_REPORT_MIN), HV_REPORT_MAX);
+#endif
+    return report;
+}
+
+report_mouse_t motion_task(report_mouse_t report) {
+    if (keyball_get_scroll_mode()) {
+        return scroll(report);
+    }
+    if (report.x == 0 && report.y == 0) {
+        return report;
+    }
+    return accelerate(report);
+}
+
+#ifdef POINTING_DEVICE_AUTO_MOUSE_ENABLE
+
+// Pointer counts seen since `gate_start`. Scroll mode reports no pointer
+// motion, so scrolling never turns the layer on.
+static uint16_t gate_moved = 0;
+static uint16_t gate_start = 0;
+
+bool auto_mouse_activation(report_mouse_t report) {
+    if (report.buttons) {
+        return true;
+    }
+
+    uint16_t moved = abs(report.x) + abs(report.y);
+    if (moved == 0) {
+        return false;
+    }
+    if (layer_state_is(get_auto_mouse_layer())) {
+        return true;
+    }
+
+    if (timer_elapsed(gate_start) > AUTO_MOUSE_GATE_WINDOW_MS) {
+        gate_moved = 0;
+        gate_start = timer_read();
+    }
+    gate_moved += moved;
+    return gate_moved >= AUTO_MOUSE_GATE_THRESHOLD;
+}
+
+#endif
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "report.h"
+
+// Post-processing of the keyball's mouse reports, run from
+// pointing_device_task_user.
+//
+// Pointer motion is scaled by a gain looked up from its speed, so slow
+// movements get finer and fast sweeps cover more distance at the same CPI.
+// The fractional part of every scaled count is carried over to the next
+// report instead of being truncated away.
+//
+// Scroll mode stays with the keyball core (keyball_set_scroll_mode), which
+// turns motion into wheel detents divided by the scroll divider (SCRL_DVI /
+// SCRL_DVD). With POINTING_DEVICE_HIRES_SCROLL_ENABLE those detents are
+// scaled up to the hi-res resolution here. That needs a host that honours
+// the HID Resolution Multiplier, as Linux and Windows do; elsewhere
+// scrolling is about 120 times too fast.
+//
+// With POINTING_DEVICE_AUTO_MOUSE_ENABLE, the auto mouse layer only turns
+// on once the pointer has moved AUTO_MOUSE_GATE_THRESHOLD counts within
+// AUTO_MOUSE_GATE_WINDOW_MS, so sensor noise and a brushed ball do not
+// flip it. Once on, any motion or held mouse button keeps it on.
+
+#ifndef AUTO_MOUSE_GATE_THRESHOLD
+#    define AUTO_MOUSE_GATE_THRESHOLD 8
+#endif
+
+#ifndef AUTO_MOUSE_GATE_WINDOW_MS
+#    define AUTO_MOUSE_GATE_WINDOW_MS 50
+#endif
+
+report_mouse_t motion_task(report_mouse_t report);
@@ -3,3 +3,10 @@ OLED_ENABLE = yes
 TRI_LAYER_ENABLE = yes
 EXTRAKEY_ENABLE = yes
 RAW_ENABLE = yes
+DEFERRED_EXEC_ENABLE = yes
+CHORDAL_HOLD_ENABLE = yes
+HOOK_TIMING_ENABLE = no
+KEY_TRACE_ENABLE = no
+ADAPTIVE_TERM_ENABLE = no
+
+SRC += motion.c
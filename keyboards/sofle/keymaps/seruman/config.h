@@ -1,10 +1,7 @@
 #pragma once
 
-/* The way how "handedness" is decided (which half is which),
-see https://docs.qmk.fm/#/feature_split_keyboard?id=setting-handedness
-for more options.
-*/
-#define SPLIT_LAYER_STATE_ENABLE
-
 #undef ENCODER_RESOLUTION
 #define ENCODER_RESOLUTION 4
+
+// Shows matrix scans per second on the master OLED.
+#define DEBUG_MATRIX_SCAN_RATE
@@ -0,0 +1,28 @@
+// Generated by tools/oled-rle/encode.py from gopher.bin; do not edit.
+// 222 bytes PackBits-encoded from 512.
+
+#pragma once
+
+#define GOPHER_SIZE 512
+
+static const char PROGMEM gopher_rle[] = {
+    0xF8, 0x00, 0x1A, 0x38, 0xEC, 0x56, 0xAA, 0xAA, 0xD6, 0xEC, 0xDE, 0x5B,
+    0xA5, 0xA9, 0x27, 0x6C, 0xE8, 0xE8, 0xD8, 0xD0, 0x30, 0xD8, 0xA8, 0x28,
+    0xD8, 0x30, 0xE0, 0x00, 0xE0, 0x20, 0xFE, 0xA0, 0x17, 0x78, 0xEC, 0x56,
+    0xAA, 0xAA, 0xD6, 0xEC, 0xDE, 0x5B, 0xA5, 0xAD, 0xAB, 0x66, 0xEC, 0xE8,
+    0xD8, 0xD0, 0x30, 0xD8, 0xA8, 0x28, 0xD8, 0x30, 0xE0, 0xBD, 0x00, 0x01,
+    0x80, 0xE0, 0xFE, 0xA0, 0x04, 0xE0, 0x9F, 0x71, 0xCE, 0x3F, 0xFE, 0xFF,
+    0x1A, 0xF8, 0xF3, 0xF7, 0xF6, 0xF3, 0xF8, 0xC3, 0xE9, 0xC9, 0x01, 0x61,
+    0x60, 0x09, 0xE5, 0x3E, 0x03, 0x01, 0x00, 0x83, 0x86, 0x85, 0x86, 0x83,
+    0x9F, 0x71, 0xCE, 0x3F, 0xFE, 0xFF, 0x10, 0xF8, 0xF3, 0xF7, 0xF6, 0xF4,
+    0xF8, 0xE3, 0xC9, 0xC9, 0x01, 0x61, 0x60, 0x09, 0xE5, 0x7E, 0xC3, 0x81,
+    0xBD, 0x00, 0x00, 0x03, 0xFE, 0x02, 0x05, 0x72, 0xDA, 0xAB, 0xAC, 0x07,
+    0xF8, 0xFB, 0xFF, 0x03, 0xE7, 0xDB, 0xD3, 0xEF, 0xFD, 0xFF, 0x02, 0x7E,
+    0x81, 0xFF, 0xFD, 0x00, 0x0F, 0x0F, 0x0A, 0x0A, 0xEA, 0xBE, 0x53, 0x5C,
+    0x07, 0xF8, 0xFF, 0xFF, 0xEF, 0xD7, 0xDB, 0xEF, 0xF7, 0xFA, 0xFF, 0x05,
+    0x7E, 0x81, 0xEC, 0x37, 0x18, 0x0F, 0xB6, 0x00, 0x13, 0x01, 0x03, 0x7E,
+    0xCD, 0xB3, 0xD9, 0xAF, 0xB3, 0xB7, 0xD7, 0x57, 0x57, 0xDB, 0x5B, 0x5B,
+    0x75, 0x6C, 0x6B, 0xF7, 0x1C, 0xF9, 0x00, 0xFE, 0x01, 0x06, 0x03, 0x3E,
+    0xED, 0x53, 0x5B, 0x6B, 0x77, 0xFE, 0x57, 0x07, 0x51, 0xD3, 0x6E, 0x59,
+    0x63, 0x3D, 0x06, 0x03, 0xBC, 0x00,
+};
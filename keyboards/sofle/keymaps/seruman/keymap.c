@@ -1,5 +1,7 @@
 #include QMK_KEYBOARD_H
 
+#include "seruman.h"
+
 enum sofle_layers {
     /* _M_XYZ = Mac Os, _W_XYZ = Win/Linux */
     _QWERTY,
@@ -10,16 +12,38 @@ enum sofle_layers {
 
 enum custom_keycodes {
     KC_QWERTY = SAFE_RANGE,
-    KC_LOWER,
-    KC_RAISE,
-    KC_ADJUST,
+    // Shortcuts, see `shortcuts`. Keep these contiguous and last.
     KC_PRVWD,
     KC_NXTWD,
     KC_LSTRT,
     KC_LEND,
-    KC_DLINE
+    KC_DLINE,
+    KC_SUNDO,
+    KC_SCUT,
+    KC_SCOPY,
+    KC_SPSTE
+};
+
+typedef struct {
+    uint8_t mods;
+    uint8_t keycode;
+} shortcut_t;
+
+// Indexed by keycode - KC_PRVWD. Mods go through mod_config() when sent so
+// that CG_TOGG swaps them.
+static const shortcut_t PROGMEM shortcuts[] = {
+    [KC_PRVWD - KC_PRVWD] = {MOD_LALT, KC_LEFT},
+    [KC_NXTWD - KC_PRVWD] = {MOD_LALT, KC_RIGHT},
+    [KC_LSTRT - KC_PRVWD] = {MOD_LGUI, KC_LEFT},
+    [KC_LEND  - KC_PRVWD] = {MOD_LGUI, KC_RIGHT},
+    [KC_DLINE - KC_PRVWD] = {MOD_LGUI, KC_BSPC},
+    [KC_SUNDO - KC_PRVWD] = {MOD_LGUI, KC_Z},
+    [KC_SCUT  - KC_PRVWD] = {MOD_LGUI, KC_X},
+    [KC_SCOPY - KC_PRVWD] = {MOD_LGUI, KC_C},
+    [KC_SPSTE - KC_PRVWD] = {MOD_LGUI, KC_V},
 };
 
+_Static_assert(sizeof(shortcuts) / sizeof(shortcuts[0]) == KC_SPSTE - KC_PRVWD + 1, "every shortcut keycode needs a table entry");
 
 const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
 /*
@@ -43,7 +67,7 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
   KC_TAB,   KC_Q,   KC_W,    KC_E,    KC_R,    KC_T,                     KC_Y,    KC_U,    KC_I,    KC_O,    KC_P,  KC_BSLS, \
   KC_LCTL , KC_A,   KC_S,    KC_D,    KC_F,    KC_G,                     KC_H,    KC_J,    KC_K,    KC_L, KC_SCLN,  KC_QUOT, \
   KC_LSFT,  KC_Z,   KC_X,    KC_C,    KC_V,    KC_B, XXXXXXX,     XXXXXXX,KC_N,    KC_M, KC_COMM,  KC_DOT, KC_SLSH,  KC_RSFT, \
-                 KC_LBRC,KC_LALT,KC_LGUI, KC_LOWER, KC_SPC,      KC_ENT,  KC_RAISE, KC_RGUI, KC_RALT, KC_RBRC \
+                 KC_LBRC,KC_LALT,KC_LGUI, TL_LOWR,  KC_SPC,      KC_ENT,  TL_UPPR,  KC_RGUI, KC_RALT, KC_RBRC \
 ),
 
 /* LOWER
@@ -85,7 +109,7 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
   KC_GRV ,  KC_F1,   KC_F2,   KC_F3,   KC_F4,   KC_F5,                       KC_F6,   KC_F7,   KC_F8,   KC_F9,  KC_F10,  KC_F11,\
   _______,  KC_INS,  KC_PSCR,   KC_PGUP,  XXXXXXX, XXXXXXX,                        KC_PGDN, KC_PRVWD, XXXXXXX, KC_NXTWD,KC_DLINE, KC_F12, \
   _______, KC_LALT,  KC_LCTL,  KC_LSFT,  XXXXXXX, _______,                       KC_LEFT,  KC_DOWN, KC_UP, KC_RGHT,  KC_DEL, KC_BSPC, \
-  _______,KC_UNDO, KC_CUT, KC_COPY, KC_PASTE, XXXXXXX,  _______,       _______,  XXXXXXX, KC_LSTRT, XXXXXXX, KC_LEND,   XXXXXXX, _______, \
+  _______,KC_SUNDO, KC_SCUT, KC_SCOPY, KC_SPSTE, XXXXXXX,  _______,       _______,  XXXXXXX, KC_LSTRT, XXXXXXX, KC_LEND,   XXXXXXX, _______, \
                          _______, _______, _______, _______, _______,       _______, _______, _______, _______, _______ \
 ),
 /* ADJUST
@@ -102,131 +126,109 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
  *            |      |      |      |      |/       /         \      \ |      |      |      |      |
  *            `----------------------------------'           '------''---------------------------'
  */
-  [_ADJUST] = LAYOUT( \
+  [_ADJUST] = WRAP(LAYOUT, \
   XXXXXXX , XXXXXXX,  XXXXXXX ,  XXXXXXX , XXXXXXX, XXXXXXX,                     XXXXXXX, XXXXXXX, XXXXXXX, XXXXXXX, XXXXXXX, XXXXXXX, \
   QK_BOOT, XXXXXXX,KC_QWERTY,XXXXXXX,CG_TOGG,XXXXXXX,                     XXXXXXX, XXXXXXX, XXXXXXX, XXXXXXX, XXXXXXX, XXXXXXX, \
-  XXXXXXX , XXXXXXX,XXXXXXX, XXXXXXX,    XXXXXXX,  XXXXXXX,                     XXXXXXX, KC_VOLD, KC_MUTE, KC_VOLU, XXXXXXX, XXXXXXX, \
-  XXXXXXX , XXXXXXX, XXXXXXX, XXXXXXX,    XXXXXXX,  XXXXXXX, XXXXXXX,     XXXXXXX, XXXXXXX, KC_MPRV, KC_MPLY, KC_MNXT, XXXXXXX, XXXXXXX, \
+  XXXXXXX , XXXXXXX,XXXXXXX, XXXXXXX,    XXXXXXX,  XXXXXXX,                     XXXXXXX, ___MEDIA_VOLUME___,        XXXXXXX, XXXXXXX, \
+  XXXXXXX , XXXXXXX, XXXXXXX, XXXXXXX,    XXXXXXX,  XXXXXXX, XXXXXXX,     XXXXXXX, XXXXXXX, ___MEDIA_TRACK____,        XXXXXXX, XXXXXXX, \
                    _______, _______, _______, _______, _______,     _______, _______, _______, _______, _______ \
   )
 };
 
 #ifdef OLED_ENABLE
 
+#include "oled_rle.h"
+#include "gopher.h"
+
+// Bytes of the logo decoded per OLED task.
+#define LOGO_BYTES_PER_TASK 128
+
+// The logo never changes and the panel keeps its RAM while the display is
+// off, so it is only decoded once, a slice per task.
 static void render_logo(void) {
-    static const char PROGMEM gopher[] = {
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x38, 0xEC, 0x56,
-    0xAA, 0xAA, 0xD6, 0xEC, 0xDE, 0x5B,
-    0xA5, 0xA9, 0x27, 0x6C, 0xE8, 0xE8,
-    0xD8, 0xD0, 0x30, 0xD8, 0xA8, 0x28,
-    0xD8, 0x30, 0xE0, 0x00, 0xE0, 0x20,
-    0xA0, 0xA0, 0xA0, 0x78, 0xEC, 0x56,
-    0xAA, 0xAA, 0xD6, 0xEC, 0xDE, 0x5B,
-    0xA5, 0xAD, 0xAB, 0x66, 0xEC, 0xE8,
-    0xD8, 0xD0, 0x30, 0xD8, 0xA8, 0x28,
-    0xD8, 0x30, 0xE0, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x80,
-    0xE0, 0xA0, 0xA0, 0xA0, 0xE0, 0x9F,
-    0x71, 0xCE, 0x3F, 0xFF, 0xFF, 0xFF,
-    0xF8, 0xF3, 0xF7, 0xF6, 0xF3, 0xF8,
-    0xC3, 0xE9, 0xC9, 0x01, 0x61, 0x60,
-    0x09, 0xE5, 0x3E, 0x03, 0x01, 0x00,
-    0x83, 0x86, 0x85, 0x86, 0x83, 0x9F,
-    0x71, 0xCE, 0x3F, 0xFF, 0xFF, 0xFF,
-    0xF8, 0xF3, 0xF7, 0xF6, 0xF4, 0xF8,
-    0xE3, 0xC9, 0xC9, 0x01, 0x61, 0x60,
-    0x09, 0xE5, 0x7E, 0xC3, 0x81, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x03, 0x02, 0x02, 0x02, 0x72,
-    0xDA, 0xAB, 0xAC, 0x07, 0xF8, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xE7,
-    0xDB, 0xD3, 0xEF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0x7E, 0x81, 0xFF, 0x00, 0x00,
-    0x00, 0x00, 0x0F, 0x0A, 0x0A, 0xEA,
-    0xBE, 0x53, 0x5C, 0x07, 0xF8, 0xFF,
-    0xFF, 0xEF, 0xD7, 0xDB, 0xEF, 0xF7,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0x7E, 0x81, 0xEC, 0x37, 0x18,
-    0x0F, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x01, 0x03,
-    0x7E, 0xCD, 0xB3, 0xD9, 0xAF, 0xB3,
-    0xB7, 0xD7, 0x57, 0x57, 0xDB, 0x5B,
-    0x5B, 0x75, 0x6C, 0x6B, 0xF7, 0x1C,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x01, 0x01, 0x01, 0x03,
-    0x3E, 0xED, 0x53, 0x5B, 0x6B, 0x77,
-    0x57, 0x57, 0x57, 0x51, 0xD3, 0x6E,
-    0x59, 0x63, 0x3D, 0x06, 0x03, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00,
-    };
-
-    oled_write_raw_P(gopher, sizeof(gopher));
+    static oled_rle_t logo;
+    static bool       rendered = false;
+
+    if (rendered) {
+        return;
+    }
+    if (logo.src == NULL) {
+        oled_rle_start(&logo, gopher_rle, GOPHER_SIZE);
+    }
+    rendered = oled_rle_step(&logo, LOGO_BYTES_PER_TASK);
 }
 
-static void print_status_narrow(void) {
-    // Print current layer
-    oled_write_ln_P(PSTR("LAYER"), false);
-    switch (get_highest_layer(layer_state)) {
+// Padded to the full width of the rotated display, so that writing a new
+// name overwrites the old one without clearing the row.
+static const char *layer_name(uint8_t layer) {
+    switch (layer) {
         case _QWERTY:
-            oled_write_P(PSTR("Base\n"), false);
-            break;
+            return PSTR("Base ");
         case _RAISE:
-            oled_write_P(PSTR("Raise"), false);
-            break;
+            return PSTR("Raise");
         case _LOWER:
-            oled_write_P(PSTR("Lower"), false);
-            break;
+            return PSTR("Lower");
         case _ADJUST:
-            oled_write_P(PSTR("Adj\n"), false);
-            break;
+            return PSTR("Adj  ");
         default:
-            oled_write_ln_P(PSTR("Undef"), false);
+            return PSTR("Undef");
     }
 }
 
+// Only rewrites the rows whose content changed; labels are written once.
+static void print_status_narrow(void) {
+    static bool    drawn      = false;
+    static uint8_t last_layer = 0;
+
+    uint8_t layer = get_highest_layer(layer_state);
+
+    if (!drawn) {
+        oled_set_cursor(0, 0);
+        oled_write_P(PSTR("LAYER"), false);
+    }
+    if (!drawn || layer != last_layer) {
+        oled_set_cursor(0, 1);
+        oled_write_P(layer_name(layer), false);
+        last_layer = layer;
+    }
+
+#ifdef DEBUG_MATRIX_SCAN_RATE
+    // Matrix scans per second, updated by QMK once a second.
+    static uint32_t last_rate = 0;
+
+    uint32_t rate = get_matrix_scan_rate();
+
+    if (!drawn) {
+        oled_set_cursor(0, 3);
+        oled_write_P(PSTR("SCAN"), false);
+    }
+    if (!drawn || rate != last_rate) {
+        oled_set_cursor(0, 4);
+        oled_write(get_u16_str(MIN(rate, UINT16_MAX), ' '), false);
+        last_rate = rate;
+    }
+#endif
+
+#ifdef OUTPUT_QUEUE_ENABLE
+    // Shortcut events still waiting to be sent.
+    static uint8_t last_depth = 0;
+
+    uint8_t depth = output_queue_depth();
+
+    if (!drawn) {
+        oled_set_cursor(0, 6);
+        oled_write_P(PSTR("QUEUE"), false);
+    }
+    if (!drawn || depth != last_depth) {
+        oled_set_cursor(0, 7);
+        oled_write(get_u8_str(depth, ' '), false);
+        last_depth = depth;
+    }
+#endif
+
+    drawn = true;
+}
+
 oled_rotation_t oled_init_user(oled_rotation_t rotation) {
     if (is_keyboard_master()) {
         return OLED_ROTATION_270;
@@ -235,6 +237,8 @@ oled_rotation_t oled_init_user(oled_rotation_t rotation) {
 }
 
 bool oled_task_user(void) {
+    HOOK_TIMING_SCOPE(HOOK_OLED);
+
     if (is_keyboard_master()) {
         print_status_narrow();
     } else {
@@ -245,144 +249,55 @@ bool oled_task_user(void) {
 
 #endif
 
+static bool process_shortcut(uint16_t keycode, keyrecord_t *record) {
+    if (keycode < KC_PRVWD || keycode > KC_SPSTE) {
+        return true;
+    }
+
+    // Shortcut sent for each key still held, or all zero if its press was
+    // refused. Releases what was pressed even if CG_TOGG flipped since.
+    static shortcut_t held[sizeof(shortcuts) / sizeof(shortcuts[0])];
+
+    uint8_t index = keycode - KC_PRVWD;
+
+    if (!record->event.pressed) {
+        if (held[index].keycode != KC_NO) {
+            output_queue_release_chord(held[index].mods, held[index].keycode);
+            held[index] = (shortcut_t){0};
+        }
+        return false;
+    }
+
+    const shortcut_t *shortcut = &shortcuts[index];
+    uint8_t           mods     = mod_config(pgm_read_byte(&shortcut->mods));
+    uint8_t           code     = pgm_read_byte(&shortcut->keycode);
 
+    if (output_queue_press_chord(mods, code)) {
+        held[index] = (shortcut_t){mods, code};
+    }
+    return false;
+}
+
+bool process_record_keymap(uint16_t keycode, keyrecord_t *record) {
+    if (!process_shortcut(keycode, record)) {
+        return false;
+    }
 
-bool process_record_user(uint16_t keycode, keyrecord_t *record) {
     switch (keycode) {
         case KC_QWERTY:
             if (record->event.pressed) {
                 set_single_persistent_default_layer(_QWERTY);
             }
             return false;
-        case KC_LOWER:
-            if (record->event.pressed) {
-                layer_on(_LOWER);
-                update_tri_layer(_LOWER, _RAISE, _ADJUST);
-            } else {
-                layer_off(_LOWER);
-                update_tri_layer(_LOWER, _RAISE, _ADJUST);
-            }
-            return false;
-        case KC_RAISE:
-            if (record->event.pressed) {
-                layer_on(_RAISE);
-                update_tri_layer(_LOWER, _RAISE, _ADJUST);
-            } else {
-                layer_off(_RAISE);
-                update_tri_layer(_LOWER, _RAISE, _ADJUST);
-            }
-            return false;
-        case KC_ADJUST:
-            if (record->event.pressed) {
-                layer_on(_ADJUST);
-            } else {
-                layer_off(_ADJUST);
-            }
-            return false;
-        case KC_PRVWD:
-            if (record->event.pressed) {
-                register_mods(mod_config(MOD_LALT));
-                register_code(KC_LEFT);
-            } else {
-                unregister_mods(mod_config(MOD_LALT));
-                unregister_code(KC_LEFT);
-            }
-            break;
-        case KC_NXTWD:
-            if (record->event.pressed) {
-                register_mods(mod_config(MOD_LALT));
-                register_code(KC_RIGHT);
-            } else {
-                unregister_mods(mod_config(MOD_LALT));
-                unregister_code(KC_RIGHT);
-            }
-            break;
-        case KC_LSTRT:
-            if (record->event.pressed) {
-                register_mods(mod_config(MOD_LGUI));
-                register_code(KC_LEFT);
-            } else {
-                unregister_mods(mod_config(MOD_LGUI));
-                unregister_code(KC_LEFT);
-            }
-            break;
-        case KC_LEND:
-            if (record->event.pressed) {
-                register_mods(mod_config(MOD_LGUI));
-                register_code(KC_RIGHT);
-            } else {
-                unregister_mods(mod_config(MOD_LGUI));
-                unregister_code(KC_RIGHT);
-            }
-            break;
-        case KC_DLINE:
-            if (record->event.pressed) {
-                register_mods(mod_config(MOD_LGUI));
-                register_code(KC_BSPC);
-            } else {
-                unregister_mods(mod_config(MOD_LGUI));
-                unregister_code(KC_BSPC);
-            }
-            break;
-        case KC_COPY:
-            if (record->event.pressed) {
-                register_mods(mod_config(MOD_LGUI));
-                register_code(KC_C);
-            } else {
-                unregister_mods(mod_config(MOD_LGUI));
-                unregister_code(KC_C);
-            }
-            return false;
-        case KC_PASTE:
-            if (record->event.pressed) {
-                register_mods(mod_config(MOD_LGUI));
-                register_code(KC_V);
-            } else {
-                unregister_mods(mod_config(MOD_LGUI));
-                unregister_code(KC_V);
-            }
-            return false;
-        case KC_CUT:
-            if (record->event.pressed) {
-                register_mods(mod_config(MOD_LGUI));
-                register_code(KC_X);
-            } else {
-                unregister_mods(mod_config(MOD_LGUI));
-                unregister_code(KC_X);
-            }
-            return false;
-            break;
-        case KC_UNDO:
-            if (record->event.pressed) {
-                register_mods(mod_config(MOD_LGUI));
-                register_code(KC_Z);
-            } else {
-                unregister_mods(mod_config(MOD_LGUI));
-                unregister_code(KC_Z);
-            }
-            return false;
     }
     return true;
 }
 
-#ifdef ENCODER_ENABLE
-
-bool encoder_update_user(uint8_t index, bool clockwise) {
-    if (index == 0) {
-        if (clockwise) {
-            tap_code(KC_PGDN);
-        } else {
-            tap_code(KC_PGUP);
-        }
-    } else if (index == 1) {
-        if (clockwise) {
-            tap_code(KC_PGDN);
-        } else {
-            tap_code(KC_PGUP);
-        }
-    }
+#ifdef ENCODER_ACCEL_ENABLE
 
-    return false;
-}
+const uint16_t PROGMEM encoder_accel_map[NUM_ENCODERS][2] = {
+    {KC_PGUP, KC_PGDN},
+    {KC_PGUP, KC_PGDN},
+};
 
 #endif
@@ -0,0 +1,36 @@
+#include QMK_KEYBOARD_H
+
+#include "oled_rle.h"
+
+void oled_rle_start(oled_rle_t *rle, const char *data, uint16_t size) {
+    rle->src   = data;
+    rle->index = 0;
+    rle->size  = size;
+    rle->run   = 0;
+}
+
+bool oled_rle_step(oled_rle_t *rle, uint16_t budget) {
+    while (rle->index < rle->size && budget > 0) {
+        if (rle->run == 0) {
+            int8_t header = pgm_read_byte(rle->src++);
+            if (header == -128) {
+                continue;
+            }
+            if (header >= 0) {
+                rle->literal = true;
+                rle->run     = header + 1;
+            } else {
+                rle->literal = false;
+                rle->run     = 1 - header;
+                rle->fill    = pgm_read_byte(rle->src++);
+            }
+        }
+
+        char data = rle->literal ? pgm_read_byte(rle->src++) : rle->fill;
+        oled_write_raw_byte(data, rle->index++);
+        rle->run--;
+        budget--;
+    }
+
+    return rle->index >= rle->size;
+}
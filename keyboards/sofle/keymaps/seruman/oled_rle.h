@@ -0,0 +1,23 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Streaming decoder for PackBits-compressed OLED framebuffers, as produced
+// by tools/oled-rle/encode.py. Bytes go straight into the OLED buffer, and
+// each step decodes a bounded number of them so a large image can be spread
+// over several OLED tasks.
+typedef struct {
+    const char *src;   // Next encoded byte, in PROGMEM.
+    uint16_t    index; // Next framebuffer byte to write.
+    uint16_t    size;  // Decoded image size.
+    uint8_t     run;   // Bytes left in the current packet.
+    bool        literal;
+    char        fill;
+} oled_rle_t;
+
+void oled_rle_start(oled_rle_t *rle, const char *data, uint16_t size);
+
+// Decodes at most `budget` bytes. Returns true once the whole image has
+// been written.
+bool oled_rle_step(oled_rle_t *rle, uint16_t budget);
@@ -2,5 +2,14 @@
 OLED_ENABLE = yes
 OLED_DRIVER = ssd1306
 ENCODER_ENABLE = yes
+ENCODER_ACCEL_ENABLE = yes
+OUTPUT_QUEUE_ENABLE = yes
 CONSOLE_ENABLE = no
 EXTRAKEY_ENABLE = yes
+TRI_LAYER_ENABLE = yes
+HOOK_TIMING_ENABLE = no
+
+# gopher.h is generated from gopher.bin by tools/oled-rle.
+ifeq ($(strip $(OLED_ENABLE)), yes)
+    SRC += oled_rle.c
+endif
@@ -0,0 +1,41 @@
+# Builds one keymap for the host, as QMK would for the board, into a replay
+# binary:
+#
+#     make -f board.mk OUT=build/replay-cygnus BOARD=cygnus KEYBOARD=cygnus
+#
+# The board's stub/<board>.mk, the keymap's rules.mk and users/seruman's
+# rules.mk are read in that order, and the features they turn on become
+# defines the same way QMK's build turns them into OPT_DEFS. Any of their
+# variables can be overridden on the command line.
+
+KEYMAP_PATH := ../keyboards/$(KEYBOARD)/keymaps/seruman
+USER_PATH   := ../users/seruman
+
+# Displays are not emulated; what the keymaps draw is left out.
+override OLED_ENABLE := no
+
+SRC      :=
+OPT_DEFS :=
+
+include stub/$(BOARD).mk
+include $(KEYMAP_PATH)/rules.mk
+include $(USER_PATH)/rules.mk
+
+CORE_FEATURES := SPLIT_KEYBOARD POINTING_DEVICE_ENABLE RAW_ENABLE TAP_DANCE_ENABLE TRI_LAYER_ENABLE DEFERRED_EXEC_ENABLE ENCODER_ENABLE
+OPT_DEFS += $(foreach feature,$(CORE_FEATURES),$(if $(filter yes,$(strip $($(feature)))),-D$(feature)))
+
+# SRC names files relative to the keymap, the userspace or, for the board's
+# own, stub/.
+SOURCES := replay.c stub/core.c stub/keymap_introspection.c
+SOURCES += $(foreach file,$(SRC),$(firstword $(wildcard $(addsuffix /$(file),$(KEYMAP_PATH) $(USER_PATH) stub))))
+
+CFLAGS ?= -O2 -g
+CFLAGS += -std=gnu11 -Wall -Werror
+CPPFLAGS += -Istub -I$(KEYMAP_PATH) -I$(USER_PATH) $(OPT_DEFS)
+CPPFLAGS += -DQMK_KEYBOARD_H='"$(BOARD).h"' -DKEYMAP_C='"$(abspath $(KEYMAP_PATH))/keymap.c"'
+CPPFLAGS += $(addprefix -include ,$(wildcard $(KEYMAP_PATH)/config.h $(USER_PATH)/config.h))
+
+# Rebuilt whenever the features change as well.
+$(OUT): $(SOURCES) $(KEYMAP_PATH)/keymap.c $(wildcard stub/*.h $(KEYMAP_PATH)/*.h $(USER_PATH)/*.h $(KEYMAP_PATH)/*.mk $(USER_PATH)/*.mk) stub/$(BOARD).mk board.mk
+	@mkdir -p $(dir $@)
+	$(CC) $(CPPFLAGS) $(CFLAGS) $(SOURCES) -o $@
@@ -0,0 +1,205 @@
+// Replays key traces through a keymap built for the host and checks what
+// it does along the way.
+//
+// A trace is a text file, one step per line; `#` starts a comment. Time only
+// moves forward; main loop passes run for every millisecond in between.
+//
+//   <ms> <row> <col> down|up         a matrix event at <ms>, through the
+//                                    stand-in core and the keymap's hooks
+//   expect hold|tap                  how the latest tap-hold key settled
+//   expect term <row> <col> <ms>     get_tapping_term for the key there
+//   expect layer <n>                 the highest layer on, default layer
+//                                    included
+//   expect report <mods> [<key>...]  the keyboard report, in hex: mods,
+//                                    then keycodes in the order pressed
+//   idle <ms>                        lets time pass
+//   reboot                           restarts, keeping the EEPROM
+//
+// Prints each failed expectation and the time spent per key event, and
+// exits non-zero if anything failed.
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include QMK_KEYBOARD_H
+
+#include "core.h"
+
+typedef struct {
+    const char *path;
+    unsigned    line;
+    unsigned    failures;
+
+    unsigned events;
+    double   total_ns;
+    double   max_ns;
+} replay_t;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void fail(replay_t *replay, const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+static void fail(replay_t *replay, const char *format, ...) {
+    va_list args;
+
+    printf("%s:%u: ", replay->path, replay->line);
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+    printf("\n");
+    replay->failures++;
+}
+
+static bool in_matrix(unsigned row, unsigned col) {
+    return row < MATRIX_ROWS && col < MATRIX_COLS;
+}
+
+static void key_event(replay_t *replay, unsigned ms, unsigned row, unsigned col, bool pressed) {
+    if (ms < timer_now) {
+        fail(replay, "time goes back to %u from %u", ms, (unsigned)timer_now);
+        return;
+    }
+    core_run(ms);
+
+    double start = now_ns();
+    core_key_event((keypos_t){.col = col, .row = row}, pressed);
+    double elapsed = now_ns() - start;
+
+    replay->total_ns += elapsed;
+    replay->max_ns = MAX(replay->max_ns, elapsed);
+    replay->events++;
+}
+
+static uint16_t tapping_term_at(keypos_t key) {
+#ifdef TAPPING_TERM_PER_KEY
+    keyrecord_t record = {.event = {.key = key, .type = KEY_EVENT}};
+    return get_tapping_term(core_keycode_at(key), &record);
+#else
+    return TAPPING_TERM;
+#endif
+}
+
+// "<mods> [<key>...]", compared with the report the core would send.
+static void expect_report(replay_t *replay, const char *text) {
+    const core_report_t *report = core_report();
+    uint8_t              mods   = report->mods | report->weak_mods;
+    unsigned             expected[KEYBOARD_REPORT_KEYS + 1];
+    unsigned             count = 0;
+    int                  used;
+
+    while (count < KEYBOARD_REPORT_KEYS + 1 && sscanf(text, "%x%n", &expected[count], &used) == 1) {
+        text += used;
+        count++;
+    }
+    if (count == 0 || text[strspn(text, " \t")] != '\0') {
+        fail(replay, "bad report: %s", text);
+        return;
+    }
+
+    bool same = expected[0] == mods;
+    for (unsigned i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        same = same && report->keys[i] == (i + 1 < count ? expected[i + 1] : KC_NO);
+    }
+    if (!same) {
+        char actual[3 * (KEYBOARD_REPORT_KEYS + 1) + 1];
+        int  length = snprintf(actual, sizeof(actual), "%02x", mods);
+        for (unsigned i = 0; i < KEYBOARD_REPORT_KEYS && report->keys[i] != KC_NO; i++) {
+            length += snprintf(actual + length, sizeof(actual) - length, " %02x", report->keys[i]);
+        }
+        fail(replay, "report is %s", actual);
+    }
+}
+
+static void step(replay_t *replay, const char *text) {
+    unsigned ms, row, col, value;
+    char     word[8];
+    int      used = 0;
+
+    if (sscanf(text, "%u %u %u %7s", &ms, &row, &col, word) == 4) {
+        if (!in_matrix(row, col) || (strcmp(word, "down") != 0 && strcmp(word, "up") != 0)) {
+            fail(replay, "bad key event: %s", text);
+            return;
+        }
+        key_event(replay, ms, row, col, strcmp(word, "down") == 0);
+    } else if (sscanf(text, "expect term %u %u %u", &row, &col, &value) == 3) {
+        if (!in_matrix(row, col)) {
+            fail(replay, "bad key: %s", text);
+            return;
+        }
+        uint16_t term = tapping_term_at((keypos_t){.col = col, .row = row});
+        if (term != value) {
+            fail(replay, "tapping term of %u,%u is %u, expected %u", row, col, term, value);
+        }
+    } else if (sscanf(text, "expect layer %u", &value) == 1) {
+        uint8_t layer = get_highest_layer(layer_state | default_layer_state);
+        if (layer != value) {
+            fail(replay, "layer %u is on, expected %u", layer, value);
+        }
+    } else if (sscanf(text, "expect report %n", &used) == 0 && used > 0) {
+        expect_report(replay, text + used);
+    } else if (sscanf(text, "expect %7s", word) == 1 && (strcmp(word, "hold") == 0 || strcmp(word, "tap") == 0)) {
+        core_settled_t expected = strcmp(word, "hold") == 0 ? CORE_SETTLED_HOLD : CORE_SETTLED_TAP;
+        core_settled_t settled  = core_take_settled();
+        if (settled == CORE_SETTLED_NONE) {
+            fail(replay, "no tap-hold key settled, expected %s", word);
+        } else if (settled != expected) {
+            fail(replay, "tap-hold key settled as %s, expected %s", settled == CORE_SETTLED_HOLD ? "hold" : "tap", word);
+        }
+    } else if (sscanf(text, "idle %u", &ms) == 1) {
+        core_run(timer_now + ms);
+    } else if (strcmp(text, "reboot") == 0) {
+        core_init(false);
+    } else {
+        fail(replay, "unknown step: %s", text);
+    }
+}
+
+static unsigned replay_file(const char *path) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        perror(path);
+        return 1;
+    }
+
+    replay_t replay = {.path = path};
+    char     text[128];
+
+    timer_now = 0;
+    core_init(true);
+
+    while (fgets(text, sizeof(text), file)) {
+        replay.line++;
+        text[strcspn(text, "#\r\n")] = '\0';
+        // Trailing blanks.
+        for (size_t len = strlen(text); len > 0 && (text[len - 1] == ' ' || text[len - 1] == '\t'); len--) {
+            text[len - 1] = '\0';
+        }
+        if (text[0] != '\0') {
+            step(&replay, text);
+        }
+    }
+    fclose(file);
+
+    printf("%s: %u key events, %.0f ns mean, %.0f ns max, %u failed\n", path, replay.events, replay.events ? replay.total_ns / replay.events : 0, replay.max_ns, replay.failures);
+    return replay.failures;
+}
+
+int main(int argc, char **argv) {
+    unsigned failures = 0;
+
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <trace>...\n", argv[0]);
+        return 2;
+    }
+    for (int i = 1; i < argc; i++) {
+        failures += replay_file(argv[i]);
+    }
+    return failures ? 1 : 0;
+}
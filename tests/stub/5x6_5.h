@@ -0,0 +1,35 @@
+#pragma once
+
+// Stands in for keyboards/handwired/dactyl_manuform/5x6_5: a split 5x6
+// with five thumb keys a side. Each half has rows of its own, the right
+// half's after the left's; within a half, keys sit where the layout shows
+// them rather than where the board wires them.
+
+#define MATRIX_ROWS 12
+#define MATRIX_COLS 6
+
+#include "quantum.h"
+
+// clang-format off
+#define LAYOUT_5x6_5( \
+    L00, L01, L02, L03, L04, L05,                     R00, R01, R02, R03, R04, R05, \
+    L10, L11, L12, L13, L14, L15,                     R10, R11, R12, R13, R14, R15, \
+    L20, L21, L22, L23, L24, L25,                     R20, R21, R22, R23, R24, R25, \
+    L30, L31, L32, L33, L34, L35,                     R30, R31, R32, R33, R34, R35, \
+              L40, L41,      L42, L43, L44, R40, R41, R42,      R43, R44,           \
+                                  L50, L51, R50, R51                                \
+) { \
+    {L00, L01, L02, L03, L04, L05}, \
+    {L10, L11, L12, L13, L14, L15}, \
+    {L20, L21, L22, L23, L24, L25}, \
+    {L30, L31, L32, L33, L34, L35}, \
+    {L40, L41, L42, L43, L44, KC_NO}, \
+    {L50, L51, KC_NO, KC_NO, KC_NO, KC_NO}, \
+    {R00, R01, R02, R03, R04, R05}, \
+    {R10, R11, R12, R13, R14, R15}, \
+    {R20, R21, R22, R23, R24, R25}, \
+    {R30, R31, R32, R33, R34, R35}, \
+    {R40, R41, R42, R43, R44, KC_NO}, \
+    {R50, R51, KC_NO, KC_NO, KC_NO, KC_NO}, \
+}
+// clang-format on
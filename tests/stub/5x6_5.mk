@@ -0,0 +1,3 @@
+# What keyboards/handwired/dactyl_manuform/5x6_5 sets for its keymaps. The
+# keymap's rules.mk turns on the split as well.
+SPLIT_KEYBOARD = yes
@@ -0,0 +1,701 @@
+#include QMK_KEYBOARD_H
+
+#include "core.h"
+#ifdef RAW_ENABLE
+#    include "raw_hid.h"
+#endif
+
+// The QMK core, as far as the keymaps and users/seruman need it: key events
+// go through tap-hold and tap dance much as action_tapping.c and
+// process_tap_dance.c handle them, then through process_record_user, then
+// to the actions of the keycodes they resolved to. Output ends up in a
+// single keyboard report.
+
+#define WAITING_BUFFER_SIZE 8
+#define MAX_DEFERRED_EXECUTORS 8
+
+uint32_t      timer_now;
+layer_state_t layer_state;
+layer_state_t default_layer_state;
+
+// Per key, what its press resolved to, so its release does the same even
+// if the layers changed meanwhile.
+static uint16_t pressed_keycodes[MATRIX_ROWS][MATRIX_COLS];
+static uint8_t  pressed_taps[MATRIX_ROWS][MATRIX_COLS];
+
+// The tap-hold key pressed and not settled yet, and the events after it.
+static bool           tapping;
+static keyrecord_t    tapping_key;
+static keyrecord_t    waiting_buffer[WAITING_BUFFER_SIZE];
+static uint8_t        waiting_count;
+static core_settled_t settled;
+
+#ifdef FLOW_TAP_TERM
+static uint16_t flow_tap_prev_keycode;
+static uint16_t flow_tap_prev_time;
+#endif
+
+static core_report_t report;
+static bool          swap_ctl_gui;
+
+#ifdef TAP_DANCE_ENABLE
+static uint16_t active_td;
+static uint16_t last_tap_time;
+#endif
+
+#ifdef DEFERRED_EXEC_ENABLE
+typedef struct {
+    deferred_token         token;
+    uint32_t               trigger_time;
+    deferred_exec_callback callback;
+    void                  *cb_arg;
+} deferred_executor_t;
+
+static deferred_executor_t executors[MAX_DEFERRED_EXECUTORS];
+static deferred_token      last_token;
+#endif
+
+#if defined(EECONFIG_USER_DATA_SIZE) && EECONFIG_USER_DATA_SIZE > 0
+static uint8_t eeprom_user[EECONFIG_USER_DATA_SIZE];
+#endif
+static uint32_t eeprom_kb;
+
+// Keymap and layers.
+
+uint16_t keymap_key_to_keycode(uint8_t layer, keypos_t key) {
+    if (layer >= keymap_layer_count() || key.row >= MATRIX_ROWS || key.col >= MATRIX_COLS) {
+        return KC_TRNS;
+    }
+    return pgm_read_word(&keymaps[layer][key.row][key.col]);
+}
+
+uint16_t core_keycode_at(keypos_t key) {
+    layer_state_t state = layer_state | default_layer_state;
+
+    for (int8_t layer = 31; layer >= 0; layer--) {
+        if (state & ((layer_state_t)1 << layer)) {
+            uint16_t keycode = keymap_key_to_keycode(layer, key);
+            if (keycode != KC_TRNS) {
+                return keycode;
+            }
+        }
+    }
+    return keymap_key_to_keycode(0, key);
+}
+
+uint8_t get_highest_layer(layer_state_t state) {
+    uint8_t layer = 0;
+    while (state >>= 1) {
+        layer++;
+    }
+    return layer;
+}
+
+bool layer_state_is(uint8_t layer) {
+    return layer_state == 0 ? layer == 0 : (layer_state & ((layer_state_t)1 << layer)) != 0;
+}
+
+void layer_state_set(layer_state_t state) {
+    layer_state = layer_state_set_user(state);
+}
+
+void layer_on(uint8_t layer) {
+    layer_state_set(layer_state | (layer_state_t)1 << layer);
+}
+
+void layer_off(uint8_t layer) {
+    layer_state_set(layer_state & ~((layer_state_t)1 << layer));
+}
+
+void layer_move(uint8_t layer) {
+    layer_state_set((layer_state_t)1 << layer);
+}
+
+void default_layer_set(layer_state_t state) {
+    default_layer_state = state;
+}
+
+void set_single_persistent_default_layer(uint8_t default_layer) {
+    default_layer_set((layer_state_t)1 << default_layer);
+}
+
+layer_state_t update_tri_layer_state(layer_state_t state, uint8_t layer1, uint8_t layer2, uint8_t layer3) {
+    layer_state_t mask12 = ((layer_state_t)1 << layer1) | ((layer_state_t)1 << layer2);
+    layer_state_t mask3  = (layer_state_t)1 << layer3;
+
+    return (state & mask12) == mask12 ? (state | mask3) : (state & ~mask3);
+}
+
+// Keyboard report.
+
+uint8_t get_mods(void) {
+    return report.mods;
+}
+
+uint8_t get_weak_mods(void) {
+    return report.weak_mods;
+}
+
+void register_mods(uint8_t mods) {
+    report.mods |= mods;
+}
+
+void unregister_mods(uint8_t mods) {
+    report.mods &= ~mods;
+}
+
+// The 5-bit mods of keycodes, right mods with 0x10, as report bits.
+static uint8_t mod_bits(uint8_t mods) {
+    return mods & 0x10 ? (mods & 0x0F) << 4 : mods & 0x0F;
+}
+
+void register_code(uint8_t code) {
+    if (IS_MODIFIER_KEYCODE(code)) {
+        report.mods |= MOD_BIT(code);
+        return;
+    }
+    // Media and mouse keys go out in reports of their own.
+    if (code < KC_A || code > KC_INT3) {
+        return;
+    }
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        if (report.keys[i] == code) {
+            return;
+        }
+    }
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        if (report.keys[i] == KC_NO) {
+            report.keys[i] = code;
+            return;
+        }
+    }
+}
+
+void unregister_code(uint8_t code) {
+    if (IS_MODIFIER_KEYCODE(code)) {
+        report.mods &= ~MOD_BIT(code);
+        return;
+    }
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        if (report.keys[i] == code) {
+            // Keep the keys in press order.
+            memmove(&report.keys[i], &report.keys[i + 1], KEYBOARD_REPORT_KEYS - i - 1);
+            report.keys[KEYBOARD_REPORT_KEYS - 1] = KC_NO;
+            return;
+        }
+    }
+}
+
+void register_code16(uint16_t code) {
+    if (IS_QK_MODS(code)) {
+        report.weak_mods |= mod_bits(QK_MODS_GET_MODS(code));
+    }
+    register_code(QK_MODS_GET_BASIC_KEYCODE(code));
+}
+
+void unregister_code16(uint16_t code) {
+    unregister_code(QK_MODS_GET_BASIC_KEYCODE(code));
+    if (IS_QK_MODS(code)) {
+        report.weak_mods &= ~mod_bits(QK_MODS_GET_MODS(code));
+    }
+}
+
+void tap_code16(uint16_t code) {
+    register_code16(code);
+    unregister_code16(code);
+}
+
+uint8_t mod_config(uint8_t mods) {
+    if (swap_ctl_gui) {
+        uint8_t ctl = mods & MOD_MASK_CTRL;
+        uint8_t gui = mods & MOD_MASK_GUI;
+        mods        = (mods & ~MOD_MASK_CG) | (ctl << 3) | (gui >> 3);
+    }
+    return mods;
+}
+
+const core_report_t *core_report(void) {
+    return &report;
+}
+
+// EEPROM.
+
+#if defined(EECONFIG_USER_DATA_SIZE) && EECONFIG_USER_DATA_SIZE > 0
+void eeconfig_read_user_datablock(void *data, uint32_t offset, uint32_t size) {
+    memcpy(data, &eeprom_user[offset], size);
+}
+
+void eeconfig_update_user_datablock(const void *data, uint32_t offset, uint32_t size) {
+    memcpy(&eeprom_user[offset], data, size);
+}
+#endif
+
+uint32_t eeconfig_read_kb(void) {
+    return eeprom_kb;
+}
+
+void eeconfig_update_kb(uint32_t value) {
+    eeprom_kb = value;
+}
+
+#ifdef RAW_ENABLE
+void raw_hid_send(uint8_t *data, uint8_t length) {}
+#endif
+
+// Deferred execution.
+
+#ifdef DEFERRED_EXEC_ENABLE
+deferred_token defer_exec(uint32_t delay_ms, deferred_exec_callback callback, void *cb_arg) {
+    if (delay_ms == 0) {
+        return INVALID_DEFERRED_TOKEN;
+    }
+    for (uint8_t i = 0; i < MAX_DEFERRED_EXECUTORS; i++) {
+        deferred_executor_t *executor = &executors[i];
+        if (executor->token == INVALID_DEFERRED_TOKEN) {
+            if (++last_token == INVALID_DEFERRED_TOKEN) {
+                ++last_token;
+            }
+            *executor = (deferred_executor_t){last_token, timer_read32() + delay_ms, callback, cb_arg};
+            return last_token;
+        }
+    }
+    return INVALID_DEFERRED_TOKEN;
+}
+
+bool cancel_deferred_exec(deferred_token token) {
+    for (uint8_t i = 0; i < MAX_DEFERRED_EXECUTORS; i++) {
+        if (token != INVALID_DEFERRED_TOKEN && executors[i].token == token) {
+            executors[i].token = INVALID_DEFERRED_TOKEN;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void deferred_exec_task(void) {
+    for (uint8_t i = 0; i < MAX_DEFERRED_EXECUTORS; i++) {
+        deferred_executor_t *executor = &executors[i];
+        if (executor->token == INVALID_DEFERRED_TOKEN || timer_now < executor->trigger_time) {
+            continue;
+        }
+        uint32_t delay_ms = executor->callback(executor->trigger_time, executor->cb_arg);
+        if (delay_ms == 0) {
+            executor->token = INVALID_DEFERRED_TOKEN;
+        } else {
+            executor->trigger_time += delay_ms;
+        }
+    }
+}
+#else
+#    define deferred_exec_task()
+#endif
+
+// Tap dance.
+
+#ifdef TAP_DANCE_ENABLE
+static tap_dance_action_t *tap_dance_action(uint16_t keycode) {
+    uint16_t index = QK_TAP_DANCE_GET_INDEX(keycode);
+    return index < tap_dance_count() ? &tap_dance_actions[index] : NULL;
+}
+
+static void tap_dance_finish(tap_dance_action_t *action) {
+    if (action->state.finished) {
+        return;
+    }
+    action->state.finished = true;
+    if (action->fn.on_dance_finished) {
+        action->fn.on_dance_finished(&action->state, action->user_data);
+    }
+}
+
+static void tap_dance_reset(tap_dance_action_t *action) {
+    if (action->state.pressed) {
+        return;
+    }
+    if (action->fn.on_reset) {
+        action->fn.on_reset(&action->state, action->user_data);
+    }
+    action->state = (tap_dance_state_t){0};
+}
+
+// Another key pressed during a dance finishes it as interrupted. True if it
+// did, as the dance may have changed layers under that key.
+static bool preprocess_tap_dance(uint16_t keycode, keyrecord_t *record) {
+    if (!record->event.pressed || active_td == 0 || keycode == active_td) {
+        return false;
+    }
+
+    tap_dance_action_t *action         = tap_dance_action(active_td);
+    action->state.interrupted          = true;
+    action->state.interrupting_keycode = keycode;
+    tap_dance_finish(action);
+    tap_dance_reset(action);
+    active_td = 0;
+    return true;
+}
+
+static void process_tap_dance(uint16_t keycode, keyrecord_t *record) {
+    tap_dance_action_t *action = tap_dance_action(keycode);
+    if (!action) {
+        return;
+    }
+
+    action->state.pressed = record->event.pressed;
+    if (record->event.pressed) {
+        action->state.count++;
+        last_tap_time = timer_read();
+        if (action->fn.on_each_tap) {
+            action->fn.on_each_tap(&action->state, action->user_data);
+        }
+        active_td = action->state.finished ? 0 : keycode;
+    } else if (action->state.finished) {
+        tap_dance_reset(action);
+    }
+}
+
+static void tap_dance_task(void) {
+    if (active_td == 0 || timer_elapsed(last_tap_time) <= GET_TAPPING_TERM(active_td, &(keyrecord_t){0})) {
+        return;
+    }
+
+    tap_dance_action_t *action = tap_dance_action(active_td);
+    tap_dance_finish(action);
+    tap_dance_reset(action);
+    active_td = 0;
+}
+#else
+#    define preprocess_tap_dance(keycode, record) false
+#    define process_tap_dance(keycode, record)
+#    define tap_dance_task()
+#endif
+
+// Key actions, once tap-hold has settled.
+
+#ifdef TRI_LAYER_ENABLE
+#    ifndef TRI_LAYER_LOWER_LAYER
+#        define TRI_LAYER_LOWER_LAYER 1
+#    endif
+#    ifndef TRI_LAYER_UPPER_LAYER
+#        define TRI_LAYER_UPPER_LAYER 2
+#    endif
+#    ifndef TRI_LAYER_ADJUST_LAYER
+#        define TRI_LAYER_ADJUST_LAYER 3
+#    endif
+
+static void tri_layer_key(uint8_t layer, bool pressed) {
+    layer_state_t state = layer_state;
+
+    if (pressed) {
+        state |= (layer_state_t)1 << layer;
+    } else {
+        state &= ~((layer_state_t)1 << layer);
+    }
+    layer_state_set(update_tri_layer_state(state, TRI_LAYER_LOWER_LAYER, TRI_LAYER_UPPER_LAYER, TRI_LAYER_ADJUST_LAYER));
+}
+#endif
+
+static void process_action(uint16_t keycode, keyrecord_t *record) {
+    bool pressed = record->event.pressed;
+
+    if (IS_QK_BASIC(keycode) || IS_QK_MODS(keycode)) {
+        if (pressed) {
+            register_code16(keycode);
+        } else {
+            unregister_code16(keycode);
+        }
+    } else if (IS_QK_MOD_TAP(keycode)) {
+        if (record->tap.count > 0) {
+            process_action(QK_MOD_TAP_GET_TAP_KEYCODE(keycode), record);
+        } else if (pressed) {
+            register_mods(mod_bits(QK_MOD_TAP_GET_MODS(keycode)));
+        } else {
+            unregister_mods(mod_bits(QK_MOD_TAP_GET_MODS(keycode)));
+        }
+    } else if (IS_QK_LAYER_TAP(keycode)) {
+        if (record->tap.count > 0) {
+            process_action(QK_LAYER_TAP_GET_TAP_KEYCODE(keycode), record);
+        } else if (pressed) {
+            layer_on(QK_LAYER_TAP_GET_LAYER(keycode));
+        } else {
+            layer_off(QK_LAYER_TAP_GET_LAYER(keycode));
+        }
+    } else if (IS_QK_MOMENTARY(keycode)) {
+        if (pressed) {
+            layer_on(QK_MOMENTARY_GET_LAYER(keycode));
+        } else {
+            layer_off(QK_MOMENTARY_GET_LAYER(keycode));
+        }
+    } else if (IS_QK_DEF_LAYER(keycode)) {
+        if (pressed) {
+            default_layer_set((layer_state_t)1 << QK_DEF_LAYER_GET_LAYER(keycode));
+        }
+    } else if (keycode == QK_GESC) {
+        // KC_GRV with shift or GUI held on the press, released as pressed.
+        static bool grave;
+        if (pressed) {
+            grave = (report.mods & (MOD_MASK_SHIFT | MOD_MASK_GUI)) != 0;
+        }
+        process_action(grave ? KC_GRV : KC_ESC, record);
+    } else if (keycode == CG_TOGG) {
+        if (pressed) {
+            swap_ctl_gui = !swap_ctl_gui;
+        }
+#ifdef TRI_LAYER_ENABLE
+    } else if (keycode == TL_LOWR) {
+        tri_layer_key(TRI_LAYER_LOWER_LAYER, pressed);
+    } else if (keycode == TL_UPPR) {
+        tri_layer_key(TRI_LAYER_UPPER_LAYER, pressed);
+#endif
+    }
+    // Anything else, QK_BOOT and the keyboard's own keycodes included,
+    // does nothing here.
+}
+
+static void process_record(keyrecord_t *record) {
+    keypos_t key = record->event.key;
+
+    if (record->event.pressed) {
+        if (record->keycode == KC_NO) {
+            record->keycode = core_keycode_at(key);
+        }
+        pressed_keycodes[key.row][key.col] = record->keycode;
+        pressed_taps[key.row][key.col]     = record->tap.count;
+    } else {
+        record->keycode   = pressed_keycodes[key.row][key.col];
+        record->tap.count = pressed_taps[key.row][key.col];
+    }
+
+    if (preprocess_tap_dance(record->keycode, record)) {
+        record->keycode                    = core_keycode_at(key);
+        pressed_keycodes[key.row][key.col] = record->keycode;
+    }
+    if (!process_record_user(record->keycode, record)) {
+        return;
+    }
+    process_tap_dance(record->keycode, record);
+    process_action(record->keycode, record);
+}
+
+// Tap-hold.
+
+static bool is_tap_hold(uint16_t keycode) {
+    return IS_QK_MOD_TAP(keycode) || IS_QK_LAYER_TAP(keycode);
+}
+
+static bool within_tapping_term(uint16_t time) {
+    return TIMER_DIFF_16(time, tapping_key.event.time) < GET_TAPPING_TERM(tapping_key.keycode, &tapping_key);
+}
+
+#ifdef FLOW_TAP_TERM
+static bool is_flow_tap_key(uint16_t keycode) {
+    if ((get_mods() & (MOD_MASK_CG | MOD_BIT_LALT)) != 0) {
+        return false;
+    }
+    if (is_tap_hold(keycode)) {
+        keycode &= 0xFF;
+    }
+    switch (keycode) {
+        case KC_A ... KC_Z:
+        case KC_SPC:
+        case KC_DOT:
+        case KC_COMM:
+        case KC_SCLN:
+        case KC_SLSH:
+            return true;
+    }
+    return false;
+}
+
+// A tap-hold key pressed soon after another key while typing is a tap,
+// settled as it arrives.
+static void flow_tap(keyrecord_t *record) {
+    uint16_t keycode = core_keycode_at(record->event.key);
+    uint16_t idle    = TIMER_DIFF_16(record->event.time, flow_tap_prev_time);
+
+    if (is_tap_hold(keycode) && is_flow_tap_key(keycode) && is_flow_tap_key(flow_tap_prev_keycode) && idle < FLOW_TAP_TERM) {
+        record->tap.count = 1;
+    }
+    flow_tap_prev_keycode = keycode;
+    flow_tap_prev_time    = record->event.time;
+}
+#else
+#    define flow_tap(record)
+#endif
+
+#ifdef CHORDAL_HOLD
+// A hold unless both keys are on the same hand. chordal_hold.c supplies
+// the hands.
+bool get_chordal_hold_default(keyrecord_t *tap_hold_record, keyrecord_t *other_record) {
+    if (tap_hold_record->event.type != KEY_EVENT || other_record->event.type != KEY_EVENT) {
+        return true;
+    }
+
+    char tap_hold_hand = chordal_hold_handedness(tap_hold_record->event.key);
+    char other_hand    = chordal_hold_handedness(other_record->event.key);
+
+    return tap_hold_hand == '*' || other_hand == '*' || tap_hold_hand != other_hand;
+}
+#endif
+
+static void tapping_event(keyrecord_t record);
+
+static void settle(bool hold) {
+    keyrecord_t waiting[WAITING_BUFFER_SIZE];
+    uint8_t     count = waiting_count;
+
+    tapping               = false;
+    settled               = hold ? CORE_SETTLED_HOLD : CORE_SETTLED_TAP;
+    tapping_key.tap.count = hold ? 0 : 1;
+    process_record(&tapping_key);
+
+    // Whatever waited is replayed from the start: another tap-hold key
+    // among it starts deciding in turn.
+    memcpy(waiting, waiting_buffer, sizeof(waiting));
+    waiting_count = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        tapping_event(waiting[i]);
+    }
+}
+
+static bool is_waiting(keypos_t key) {
+    for (uint8_t i = 0; i < waiting_count; i++) {
+        if (waiting_buffer[i].event.pressed && waiting_buffer[i].event.key.row == key.row && waiting_buffer[i].event.key.col == key.col) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void wait(keyrecord_t *record) {
+    if (waiting_count == WAITING_BUFFER_SIZE) {
+        // Out of room: QMK drops the tap-hold key's decision to a hold.
+        settle(true);
+        tapping_event(*record);
+        return;
+    }
+    waiting_buffer[waiting_count++] = *record;
+}
+
+static void tapping_event(keyrecord_t record) {
+    keypos_t key = record.event.key;
+
+    if (!tapping) {
+        if (record.event.pressed) {
+            uint16_t keycode = core_keycode_at(key);
+
+            if (is_tap_hold(keycode)) {
+                record.keycode = keycode;
+                if (record.tap.count > 0) {
+                    settled = CORE_SETTLED_TAP;
+                } else {
+                    tapping     = true;
+                    tapping_key = record;
+                    return;
+                }
+            }
+        }
+        process_record(&record);
+        return;
+    }
+
+    if (key.row == tapping_key.event.key.row && key.col == tapping_key.event.key.col) {
+        // Its release, since the tapping term has not run out yet.
+        settle(!within_tapping_term(record.event.time));
+        tapping_event(record);
+        return;
+    }
+
+    if (record.event.pressed) {
+#ifdef CHORDAL_HOLD
+        if (!get_chordal_hold(tapping_key.keycode, &tapping_key, core_keycode_at(key), &record)) {
+            settle(false);
+            tapping_event(record);
+            return;
+        }
+#endif
+        wait(&record);
+        return;
+    }
+
+    if (!is_waiting(key)) {
+        // Pressed before the tap-hold key, so not part of its decision.
+        process_record(&record);
+        return;
+    }
+#ifdef PERMISSIVE_HOLD
+    settle(true);
+    tapping_event(record);
+#else
+    wait(&record);
+#endif
+}
+
+// The main loop.
+
+void core_init(bool erase) {
+    memset(pressed_keycodes, 0, sizeof(pressed_keycodes));
+    memset(pressed_taps, 0, sizeof(pressed_taps));
+    tapping       = false;
+    waiting_count = 0;
+    settled       = CORE_SETTLED_NONE;
+#ifdef FLOW_TAP_TERM
+    flow_tap_prev_keycode = KC_NO;
+#endif
+    report       = (core_report_t){0};
+    swap_ctl_gui = false;
+#ifdef TAP_DANCE_ENABLE
+    active_td = 0;
+    for (uint16_t i = 0; i < tap_dance_count(); i++) {
+        tap_dance_actions[i].state = (tap_dance_state_t){0};
+    }
+#endif
+#ifdef DEFERRED_EXEC_ENABLE
+    memset(executors, 0, sizeof(executors));
+#endif
+    if (erase) {
+#if defined(EECONFIG_USER_DATA_SIZE) && EECONFIG_USER_DATA_SIZE > 0
+        memset(eeprom_user, 0, sizeof(eeprom_user));
+#endif
+        eeprom_kb = 0;
+    }
+
+    default_layer_state = 1;
+    layer_state         = 0;
+    keyboard_post_init_user();
+}
+
+void core_key_event(keypos_t key, bool pressed) {
+    keyrecord_t record = {
+        .event =
+            {
+                .key     = key,
+                .time    = timer_read(),
+                .type    = KEY_EVENT,
+                .pressed = pressed,
+            },
+    };
+
+    if (pressed) {
+        flow_tap(&record);
+    }
+    tapping_event(record);
+}
+
+void core_run(uint32_t until) {
+    while (timer_now < until) {
+        if (tapping && !within_tapping_term(timer_read())) {
+            settle(true);
+        }
+        tap_dance_task();
+        deferred_exec_task();
+        housekeeping_task_user();
+        timer_now++;
+    }
+}
+
+core_settled_t core_take_settled(void) {
+    core_settled_t last = settled;
+
+    settled = CORE_SETTLED_NONE;
+    return last;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "action.h"
+
+// How the replay drives the stand-in core in core.c.
+
+#define KEYBOARD_REPORT_KEYS 6
+
+// The keyboard report as it would go out next: mods, with weak mods from
+// modded keycodes kept apart, and keys in the order they were pressed.
+typedef struct {
+    uint8_t mods;
+    uint8_t weak_mods;
+    uint8_t keys[KEYBOARD_REPORT_KEYS];
+} core_report_t;
+
+typedef enum {
+    CORE_SETTLED_NONE,
+    CORE_SETTLED_TAP,
+    CORE_SETTLED_HOLD,
+} core_settled_t;
+
+// Starts over as after power on, then calls keyboard_post_init_user. Keeps
+// the EEPROM unless `erase` is set.
+void core_init(bool erase);
+
+// A matrix event at the current time.
+void core_key_event(keypos_t key, bool pressed);
+
+// Runs main loop passes, one per millisecond, until timer_now reaches
+// `until`: tapping terms and tap dances time out, deferred callbacks run,
+// then housekeeping_task_user.
+void core_run(uint32_t until);
+
+// The keycode a press of `key` resolves to on the layers now on.
+uint16_t core_keycode_at(keypos_t key);
+
+const core_report_t *core_report(void);
+
+// How the latest tap-hold key settled, then CORE_SETTLED_NONE until
+// another one does.
+core_settled_t core_take_settled(void);
@@ -0,0 +1,28 @@
+#pragma once
+
+// Stands in for keyboards/cygnus: a split 3x5+3. Each half has rows of its
+// own, the right half's after the left's; within a half, keys sit where the
+// layout shows them rather than where the board wires them.
+
+#define MATRIX_ROWS 8
+#define MATRIX_COLS 5
+
+#include "quantum.h"
+
+// clang-format off
+#define LAYOUT_split_3x5_3( \
+    L00, L01, L02, L03, L04,           R00, R01, R02, R03, R04, \
+    L10, L11, L12, L13, L14,           R10, R11, R12, R13, R14, \
+    L20, L21, L22, L23, L24,           R20, R21, R22, R23, R24, \
+                   L30, L31, L32, R30, R31, R32                 \
+) { \
+    {L00, L01, L02, L03, L04}, \
+    {L10, L11, L12, L13, L14}, \
+    {L20, L21, L22, L23, L24}, \
+    {L30, L31, L32, KC_NO, KC_NO}, \
+    {R00, R01, R02, R03, R04}, \
+    {R10, R11, R12, R13, R14}, \
+    {R20, R21, R22, R23, R24}, \
+    {R30, R31, R32, KC_NO, KC_NO}, \
+}
+// clang-format on
@@ -0,0 +1,2 @@
+# What keyboards/cygnus sets for its keymaps.
+SPLIT_KEYBOARD = yes
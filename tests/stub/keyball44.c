@@ -0,0 +1,32 @@
+#include QMK_KEYBOARD_H
+
+// The keyball core's state, as the keymap reads and writes it.
+
+keyball_t keyball = {
+    .cpi_value  = KEYBALL_CPI_DEFAULT / 100,
+    .scroll_div = KEYBALL_SCROLL_DIV_DEFAULT,
+};
+
+uint8_t keyball_get_cpi(void) {
+    return keyball.cpi_value;
+}
+
+bool keyball_get_scroll_mode(void) {
+    return keyball.scroll_mode;
+}
+
+void keyball_set_scroll_mode(bool mode) {
+    keyball.scroll_mode = mode;
+}
+
+uint8_t keyball_get_scroll_div(void) {
+    return keyball.scroll_div;
+}
+
+uint16_t pointing_device_get_hires_scroll_resolution(void) {
+    return 120;
+}
+
+uint8_t get_auto_mouse_layer(void) {
+    return AUTO_MOUSE_DEFAULT_LAYER;
+}
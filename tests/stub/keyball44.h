@@ -0,0 +1,74 @@
+#pragma once
+
+// Stands in for keyboards/keyball/keyball44: a split 3x6 with five thumb
+// keys a side and a trackball, and the parts of the keyball core the keymap
+// calls, kept in keyball44.c. Each half has rows of its own, the right
+// half's after the left's; within a half, keys sit where the layout shows
+// them rather than where the board wires them.
+
+#define MATRIX_ROWS 8
+#define MATRIX_COLS 6
+
+#include "quantum.h"
+
+// clang-format off
+#define LAYOUT_universal( \
+    L00, L01, L02, L03, L04, L05,           R00, R01, R02, R03, R04, R05, \
+    L10, L11, L12, L13, L14, L15,           R10, R11, R12, R13, R14, R15, \
+    L20, L21, L22, L23, L24, L25,           R20, R21, R22, R23, R24, R25, \
+              L30, L31, L32, L33, L34, R30, R31, R32, R33, R34            \
+) { \
+    {L00, L01, L02, L03, L04, L05}, \
+    {L10, L11, L12, L13, L14, L15}, \
+    {L20, L21, L22, L23, L24, L25}, \
+    {L30, L31, L32, L33, L34, KC_NO}, \
+    {R00, R01, R02, R03, R04, R05}, \
+    {R10, R11, R12, R13, R14, R15}, \
+    {R20, R21, R22, R23, R24, R25}, \
+    {R30, R31, R32, R33, R34, KC_NO}, \
+}
+// clang-format on
+
+// Handled by the keyball core after process_record_user, which does
+// nothing with them here.
+enum keyball_keycodes {
+    KBC_RST = QK_KB_0,
+    KBC_SAVE,
+    CPI_I100,
+    CPI_D100,
+    CPI_I1K,
+    CPI_D1K,
+    SCRL_TO,
+    SCRL_MO,
+    SCRL_DVI,
+    SCRL_DVD,
+    AML_TO,
+    AML_I50,
+    AML_D50,
+};
+
+typedef union {
+    uint32_t raw;
+    struct {
+        uint8_t cpi : 7;
+        uint8_t sdiv : 3;
+    };
+} keyball_config_t;
+
+typedef struct {
+    // CPI / 100, 0 for KEYBALL_CPI_DEFAULT.
+    uint8_t cpi_value;
+    uint8_t scroll_div;
+    bool    scroll_mode;
+} keyball_t;
+
+extern keyball_t keyball;
+
+uint8_t keyball_get_cpi(void);
+bool    keyball_get_scroll_mode(void);
+void    keyball_set_scroll_mode(bool mode);
+uint8_t keyball_get_scroll_div(void);
+
+// The pointing device is never read; these only serve motion.c.
+uint16_t pointing_device_get_hires_scroll_resolution(void);
+uint8_t  get_auto_mouse_layer(void);
@@ -0,0 +1,4 @@
+# What keyboards/keyball/keyball44 sets for its keymaps.
+SPLIT_KEYBOARD = yes
+POINTING_DEVICE_ENABLE = yes
+SRC += keyball44.c
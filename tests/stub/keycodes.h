@@ -0,0 +1,233 @@
+#pragma once
+
+// The keycodes the keymaps and users/seruman use, with QMK's values and
+// range macros.
+
+enum {
+    KC_NO   = 0x0000,
+    KC_TRNS = 0x0001,
+
+    KC_A = 0x0004,
+    KC_B,
+    KC_C,
+    KC_D,
+    KC_E,
+    KC_F,
+    KC_G,
+    KC_H,
+    KC_I,
+    KC_J,
+    KC_K,
+    KC_L,
+    KC_M,
+    KC_N,
+    KC_O,
+    KC_P,
+    KC_Q,
+    KC_R,
+    KC_S,
+    KC_T,
+    KC_U,
+    KC_V,
+    KC_W,
+    KC_X,
+    KC_Y,
+    KC_Z,
+    KC_1,
+    KC_2,
+    KC_3,
+    KC_4,
+    KC_5,
+    KC_6,
+    KC_7,
+    KC_8,
+    KC_9,
+    KC_0,
+    KC_ENT,
+    KC_ESC,
+    KC_BSPC,
+    KC_TAB,
+    KC_SPC,
+    KC_MINS,
+    KC_EQL,
+    KC_LBRC,
+    KC_RBRC,
+    KC_BSLS,
+    KC_NUHS,
+    KC_SCLN,
+    KC_QUOT,
+    KC_GRV,
+    KC_COMM,
+    KC_DOT,
+    KC_SLSH,
+    KC_CAPS,
+    KC_F1,
+    KC_F2,
+    KC_F3,
+    KC_F4,
+    KC_F5,
+    KC_F6,
+    KC_F7,
+    KC_F8,
+    KC_F9,
+    KC_F10,
+    KC_F11,
+    KC_F12,
+    KC_PSCR,
+    KC_SCRL,
+    KC_PAUS,
+    KC_INS,
+    KC_HOME,
+    KC_PGUP,
+    KC_DEL,
+    KC_END,
+    KC_PGDN,
+    KC_RGHT,
+    KC_LEFT,
+    KC_DOWN,
+    KC_UP,
+
+    KC_INT1 = 0x0087,
+    KC_INT3 = 0x0089,
+
+    KC_MUTE = 0x00A8,
+    KC_VOLU,
+    KC_VOLD,
+    KC_MNXT,
+    KC_MPRV,
+    KC_MSTP,
+    KC_MPLY,
+
+    KC_BTN1 = 0x00D1,
+    KC_BTN2,
+    KC_BTN3,
+
+    KC_LCTL = 0x00E0,
+    KC_LSFT,
+    KC_LALT,
+    KC_LGUI,
+    KC_RCTL,
+    KC_RSFT,
+    KC_RALT,
+    KC_RGUI,
+
+    CG_TOGG = 0x701D,
+
+    QK_BOOT = 0x7C00,
+    QK_GESC = 0x7C16,
+    TL_LOWR = 0x7C77,
+    TL_UPPR = 0x7C78,
+
+    QK_KB_0   = 0x7E00,
+    QK_USER_0 = 0x7E40,
+};
+
+#define KC_RIGHT KC_RGHT
+#define XXXXXXX KC_NO
+#define _______ KC_TRNS
+
+// Mods as the 5-bit field of modded keycodes and mod-taps, right mods with
+// 0x10 set.
+enum {
+    MOD_LCTL = 0x01,
+    MOD_LSFT = 0x02,
+    MOD_LALT = 0x04,
+    MOD_LGUI = 0x08,
+    MOD_RCTL = 0x11,
+    MOD_RSFT = 0x12,
+    MOD_RALT = 0x14,
+    MOD_RGUI = 0x18,
+};
+
+// Mods as the 8-bit field of a keyboard report.
+#define MOD_BIT(code) (1 << ((code)&0x07))
+#define MOD_BIT_LALT MOD_BIT(KC_LALT)
+#define MOD_MASK_CTRL (MOD_BIT(KC_LCTL) | MOD_BIT(KC_RCTL))
+#define MOD_MASK_SHIFT (MOD_BIT(KC_LSFT) | MOD_BIT(KC_RSFT))
+#define MOD_MASK_GUI (MOD_BIT(KC_LGUI) | MOD_BIT(KC_RGUI))
+#define MOD_MASK_CG (MOD_MASK_CTRL | MOD_MASK_GUI)
+
+#define QK_BASIC 0x0000
+#define QK_BASIC_MAX 0x00FF
+#define QK_MODS 0x0100
+#define QK_MODS_MAX 0x1FFF
+#define QK_MOD_TAP 0x2000
+#define QK_MOD_TAP_MAX 0x3FFF
+#define QK_LAYER_TAP 0x4000
+#define QK_LAYER_TAP_MAX 0x4FFF
+#define QK_MOMENTARY 0x5220
+#define QK_MOMENTARY_MAX 0x523F
+#define QK_DEF_LAYER 0x5240
+#define QK_DEF_LAYER_MAX 0x525F
+#define QK_TAP_DANCE 0x5700
+#define QK_TAP_DANCE_MAX 0x57FF
+#define QK_KB QK_KB_0
+#define QK_USER QK_USER_0
+
+#define SAFE_RANGE QK_USER
+
+#define IS_QK_BASIC(code) ((code) <= QK_BASIC_MAX)
+#define IS_QK_MODS(code) ((code) >= QK_MODS && (code) <= QK_MODS_MAX)
+#define IS_QK_MOD_TAP(code) ((code) >= QK_MOD_TAP && (code) <= QK_MOD_TAP_MAX)
+#define IS_QK_LAYER_TAP(code) ((code) >= QK_LAYER_TAP && (code) <= QK_LAYER_TAP_MAX)
+#define IS_QK_MOMENTARY(code) ((code) >= QK_MOMENTARY && (code) <= QK_MOMENTARY_MAX)
+#define IS_QK_DEF_LAYER(code) ((code) >= QK_DEF_LAYER && (code) <= QK_DEF_LAYER_MAX)
+#define IS_QK_TAP_DANCE(code) ((code) >= QK_TAP_DANCE && (code) <= QK_TAP_DANCE_MAX)
+#define IS_MODIFIER_KEYCODE(code) ((code) >= KC_LCTL && (code) <= KC_RGUI)
+
+#define QK_MODS_GET_MODS(code) (((code) >> 8) & 0x1F)
+#define QK_MODS_GET_BASIC_KEYCODE(code) ((code)&0xFF)
+#define QK_MOD_TAP_GET_MODS(code) (((code) >> 8) & 0x1F)
+#define QK_MOD_TAP_GET_TAP_KEYCODE(code) ((code)&0xFF)
+#define QK_LAYER_TAP_GET_LAYER(code) (((code) >> 8) & 0x0F)
+#define QK_LAYER_TAP_GET_TAP_KEYCODE(code) ((code)&0xFF)
+#define QK_MOMENTARY_GET_LAYER(code) ((code)&0x1F)
+#define QK_DEF_LAYER_GET_LAYER(code) ((code)&0x1F)
+#define QK_TAP_DANCE_GET_INDEX(code) ((code)&0xFF)
+
+#define QK_LCTL 0x0100
+#define QK_LSFT 0x0200
+#define QK_LALT 0x0400
+#define QK_LGUI 0x0800
+
+#define LCTL(kc) (QK_LCTL | (kc))
+#define LSFT(kc) (QK_LSFT | (kc))
+#define LALT(kc) (QK_LALT | (kc))
+#define LGUI(kc) (QK_LGUI | (kc))
+#define C(kc) LCTL(kc)
+#define S(kc) LSFT(kc)
+#define A(kc) LALT(kc)
+#define G(kc) LGUI(kc)
+
+#define KC_TILD S(KC_GRV)
+#define KC_EXLM S(KC_1)
+#define KC_AT S(KC_2)
+#define KC_HASH S(KC_3)
+#define KC_DLR S(KC_4)
+#define KC_PERC S(KC_5)
+#define KC_CIRC S(KC_6)
+#define KC_AMPR S(KC_7)
+#define KC_ASTR S(KC_8)
+#define KC_LPRN S(KC_9)
+#define KC_RPRN S(KC_0)
+#define KC_UNDS S(KC_MINS)
+#define KC_PLUS S(KC_EQL)
+#define KC_LCBR S(KC_LBRC)
+#define KC_RCBR S(KC_RBRC)
+#define KC_PIPE S(KC_BSLS)
+#define KC_COLN S(KC_SCLN)
+
+#define MT(mod, kc) (QK_MOD_TAP | (((mod)&0x1F) << 8) | ((kc)&0xFF))
+#define LCTL_T(kc) MT(MOD_LCTL, kc)
+#define LSFT_T(kc) MT(MOD_LSFT, kc)
+#define LALT_T(kc) MT(MOD_LALT, kc)
+#define LGUI_T(kc) MT(MOD_LGUI, kc)
+#define RCTL_T(kc) MT(MOD_RCTL, kc)
+#define RSFT_T(kc) MT(MOD_RSFT, kc)
+#define RALT_T(kc) MT(MOD_RALT, kc)
+#define RGUI_T(kc) MT(MOD_RGUI, kc)
+
+#define LT(layer, kc) (QK_LAYER_TAP | (((layer)&0x0F) << 8) | ((kc)&0xFF))
+#define MO(layer) (QK_MOMENTARY | ((layer)&0x1F))
+#define DF(layer) (QK_DEF_LAYER | ((layer)&0x1F))
+#define TD(index) (QK_TAP_DANCE | ((index)&0xFF))
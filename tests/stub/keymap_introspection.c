@@ -0,0 +1,13 @@
+// As in QMK, keymap.c is built as part of this file, so that the size of
+// its tables is known here.
+#include KEYMAP_C
+
+uint8_t keymap_layer_count(void) {
+    return sizeof(keymaps) / sizeof(keymaps[0]);
+}
+
+#ifdef TAP_DANCE_ENABLE
+uint16_t tap_dance_count(void) {
+    return sizeof(tap_dance_actions) / sizeof(tap_dance_actions[0]);
+}
+#endif
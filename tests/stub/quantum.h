@@ -0,0 +1,123 @@
+#pragma once
+
+// Stands in for QMK's quantum.h: the parts of the QMK core the keymaps and
+// users/seruman call, implemented in core.c. Included by each board's
+// header in stub/, which QMK_KEYBOARD_H names, after it has set the matrix
+// size.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "action.h"
+#include "keycodes.h"
+#include "report.h"
+#include "timer.h"
+
+#if MATRIX_ROWS <= 8
+typedef uint8_t matrix_row_t;
+#else
+typedef uint16_t matrix_row_t;
+#endif
+typedef uint32_t layer_state_t;
+
+#define PROGMEM
+#define PSTR(s) s
+#define pgm_read_byte(address) (*(const uint8_t *)(address))
+#define pgm_read_word(address) (*(const uint16_t *)(address))
+
+#ifndef MIN
+#    define MIN(x, y) ((x) < (y) ? (x) : (y))
+#endif
+#ifndef MAX
+#    define MAX(x, y) ((x) > (y) ? (x) : (y))
+#endif
+
+// Defined by keymap.c, which is built as part of keymap_introspection.c.
+extern const uint16_t keymaps[][MATRIX_ROWS][MATRIX_COLS];
+
+uint8_t  keymap_layer_count(void);
+uint16_t keymap_key_to_keycode(uint8_t layer, keypos_t key);
+
+// Layers, as in action_layer.h. Every change goes through
+// layer_state_set_user.
+extern layer_state_t layer_state;
+extern layer_state_t default_layer_state;
+
+uint8_t       get_highest_layer(layer_state_t state);
+bool          layer_state_is(uint8_t layer);
+void          layer_state_set(layer_state_t state);
+void          layer_on(uint8_t layer);
+void          layer_off(uint8_t layer);
+void          layer_move(uint8_t layer);
+void          default_layer_set(layer_state_t state);
+void          set_single_persistent_default_layer(uint8_t default_layer);
+layer_state_t update_tri_layer_state(layer_state_t state, uint8_t layer1, uint8_t layer2, uint8_t layer3);
+
+// Keyboard report output, as in action.h and action_util.h.
+uint8_t get_mods(void);
+uint8_t get_weak_mods(void);
+void    register_mods(uint8_t mods);
+void    unregister_mods(uint8_t mods);
+void    register_code(uint8_t code);
+void    unregister_code(uint8_t code);
+void    register_code16(uint16_t code);
+void    unregister_code16(uint16_t code);
+void    tap_code16(uint16_t code);
+// Mods as swapped by CG_TOGG.
+uint8_t mod_config(uint8_t mods);
+
+#ifdef TAP_DANCE_ENABLE
+// Tap dance state as QMK passes it to the finished and reset callbacks.
+typedef struct {
+    uint16_t interrupting_keycode;
+    uint8_t  count;
+    bool     pressed : 1;
+    bool     finished : 1;
+    bool     interrupted : 1;
+} tap_dance_state_t;
+
+typedef void (*tap_dance_user_fn_t)(tap_dance_state_t *state, void *user_data);
+
+typedef struct {
+    tap_dance_state_t state;
+    struct {
+        tap_dance_user_fn_t on_each_tap;
+        tap_dance_user_fn_t on_dance_finished;
+        tap_dance_user_fn_t on_reset;
+    } fn;
+    void *user_data;
+} tap_dance_action_t;
+
+extern tap_dance_action_t tap_dance_actions[];
+
+uint16_t tap_dance_count(void);
+#endif
+
+#ifdef DEFERRED_EXEC_ENABLE
+typedef uint8_t deferred_token;
+typedef uint32_t (*deferred_exec_callback)(uint32_t trigger_time, void *cb_arg);
+
+#    define INVALID_DEFERRED_TOKEN 0
+
+deferred_token defer_exec(uint32_t delay_ms, deferred_exec_callback callback, void *cb_arg);
+bool           cancel_deferred_exec(deferred_token token);
+#endif
+
+#ifdef ENCODER_ENABLE
+bool encoder_update_user(uint8_t index, bool clockwise);
+#endif
+
+// The EEPROM, in memory.
+#if defined(EECONFIG_USER_DATA_SIZE) && EECONFIG_USER_DATA_SIZE > 0
+void eeconfig_read_user_datablock(void *data, uint32_t offset, uint32_t size);
+void eeconfig_update_user_datablock(const void *data, uint32_t offset, uint32_t size);
+#endif
+uint32_t eeconfig_read_kb(void);
+void     eeconfig_update_kb(uint32_t value);
+
+// User hooks, defined by seruman.c and the keymap.
+bool          process_record_user(uint16_t keycode, keyrecord_t *record);
+layer_state_t layer_state_set_user(layer_state_t state);
+void          keyboard_post_init_user(void);
+void          housekeeping_task_user(void);
@@ -0,0 +1,7 @@
+#pragma once
+
+#include <stdint.h>
+
+// Reports are dropped; nothing listens on the host side.
+void raw_hid_send(uint8_t *data, uint8_t length);
+void raw_hid_receive(uint8_t *data, uint8_t length);
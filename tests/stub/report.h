@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stdint.h>
+
+// The mouse report of QMK's report.h, with WHEEL_EXTENDED_REPORT honoured.
+
+#define XY_REPORT_MIN INT8_MIN
+#define XY_REPORT_MAX INT8_MAX
+
+#ifdef WHEEL_EXTENDED_REPORT
+typedef int16_t mouse_hv_report_t;
+#    define HV_REPORT_MIN INT16_MIN
+#    define HV_REPORT_MAX INT16_MAX
+#else
+typedef int8_t mouse_hv_report_t;
+#    define HV_REPORT_MIN INT8_MIN
+#    define HV_REPORT_MAX INT8_MAX
+#endif
+
+typedef struct {
+    uint8_t           buttons;
+    int8_t            x;
+    int8_t            y;
+    mouse_hv_report_t v;
+    mouse_hv_report_t h;
+} report_mouse_t;
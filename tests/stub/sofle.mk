@@ -0,0 +1,2 @@
+# What keyboards/sofle sets for its keymaps.
+SPLIT_KEYBOARD = yes
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stdint.h>
+
+// Milliseconds, advanced by the main loop passes of core_run.
+extern uint32_t timer_now;
+
+#define TIMER_DIFF_16(a, b) ((uint16_t)((a) - (b)))
+
+static inline uint16_t timer_read(void) {
+    return (uint16_t)timer_now;
+}
+
+static inline uint32_t timer_read32(void) {
+    return timer_now;
+}
+
+static inline uint16_t timer_elapsed(uint16_t last) {
+    return TIMER_DIFF_16(timer_read(), last);
+}
+
+static inline uint32_t timer_elapsed32(uint32_t last) {
+    return timer_now - last;
+}
@@ -0,0 +1,105 @@
+#!/usr/bin/env python3
+"""Compresses a raw OLED framebuffer into a PackBits C header.
+
+The input is the exact byte layout oled_write_raw() expects, e.g. 512 bytes
+for a 128x32 display. The output declares `<name>_rle[]` in PROGMEM and
+`<NAME>_SIZE`, the decoded size, for oled_rle_start() to consume.
+
+PackBits: a header byte n in 0..127 is followed by n + 1 literal bytes, a
+header n in -127..-1 by one byte repeated 1 - n times. -128 is skipped.
+"""
+
+import argparse
+import sys
+from pathlib import Path
+
+MAX_PACKET = 128
+
+
+def packbits(data: bytes) -> bytes:
+    out = bytearray()
+    literal = bytearray()
+
+    def flush():
+        while literal:
+            chunk = literal[:MAX_PACKET]
+            del literal[:MAX_PACKET]
+            out.append(len(chunk) - 1)
+            out.extend(chunk)
+
+    i = 0
+    while i < len(data):
+        run = 1
+        while i + run < len(data) and data[i + run] == data[i] and run < MAX_PACKET:
+            run += 1
+
+        # A run of two only pays off when it does not split a literal.
+        if run >= 3 or (run == 2 and not literal):
+            flush()
+            out.append((1 - run) & 0xFF)
+            out.append(data[i])
+            i += run
+        else:
+            literal.append(data[i])
+            i += 1
+
+    flush()
+    return bytes(out)
+
+
+def unpackbits(data: bytes) -> bytes:
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        n = data[i] - 256 if data[i] > 127 else data[i]
+        i += 1
+        if n >= 0:
+            out.extend(data[i : i + n + 1])
+            i += n + 1
+        elif n != -128:
+            out.extend(bytes([data[i]]) * (1 - n))
+            i += 1
+    return bytes(out)
+
+
+def header(name: str, source: str, raw: bytes, packed: bytes) -> str:
+    lines = [
+        "// Generated by tools/oled-rle/encode.py from {}; do not edit.".format(source),
+        "// {} bytes PackBits-encoded from {}.".format(len(packed), len(raw)),
+        "",
+        "#pragma once",
+        "",
+        "#define {}_SIZE {}".format(name.upper(), len(raw)),
+        "",
+        "static const char PROGMEM {}_rle[] = {{".format(name),
+    ]
+    for i in range(0, len(packed), 12):
+        row = ", ".join("0x{:02X}".format(b) for b in packed[i : i + 12])
+        lines.append("    {},".format(row))
+    lines.append("};")
+    return "\n".join(lines) + "\n"
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("input", type=Path, help="raw framebuffer, e.g. gopher.bin")
+    parser.add_argument("-o", "--output", type=Path, help="header to write (default: stdout)")
+    parser.add_argument("-n", "--name", help="array name (default: input file stem)")
+    args = parser.parse_args()
+
+    raw = args.input.read_bytes()
+    packed = packbits(raw)
+    if unpackbits(packed) != raw:
+        print("{}: round trip failed".format(args.input), file=sys.stderr)
+        return 1
+
+    text = header(args.name or args.input.stem, args.input.name, raw, packed)
+    if args.output:
+        args.output.write_text(text)
+    else:
+        sys.stdout.write(text)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,189 @@
+//! Heap allocations and time per broadcast layer event: the original
+//! `to_string` + `writeln!` per client path against serializing once into a
+//! pooled frame shared by every client queue. Both send the monitor's own
+//! TaggedMessage, the latter through `Broadcaster::publish` and
+//! `message::encode` exactly as the monitor does.
+//!
+//! Run with `cargo bench --bench broadcast`. Allocations per event are
+//! printed before criterion's timings.
+
+use criterion::{black_box, criterion_group, criterion_main, Criterion};
+use std::alloc::{GlobalAlloc, Layout, System};
+use std::cell::Cell;
+use std::io::{Read, Write};
+use std::os::unix::net::UnixStream;
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::Arc;
+use std::thread;
+use std::time::Duration;
+
+#[allow(dead_code)]
+#[path = "../src/broadcast.rs"]
+mod broadcast;
+#[allow(dead_code)]
+#[path = "../src/message.rs"]
+mod message;
+#[allow(dead_code)]
+#[path = "../src/protocol.rs"]
+mod protocol;
+
+use broadcast::Broadcaster;
+use message::{LayerStatus, SocketMessage, TaggedMessage};
+use protocol::BinaryRecord;
+
+// Counts allocations made by threads that opted in, so the broadcaster's
+// writer and the draining clients do not skew the numbers.
+struct CountingAlloc;
+
+static ALLOCATIONS: AtomicU64 = AtomicU64::new(0);
+
+thread_local! {
+    static COUNTING: Cell<bool> = const { Cell::new(false) };
+}
+
+fn count() {
+    if COUNTING.try_with(Cell::get).unwrap_or(false) {
+        ALLOCATIONS.fetch_add(1, Ordering::Relaxed);
+    }
+}
+
+unsafe impl GlobalAlloc for CountingAlloc {
+    unsafe fn alloc(&self, layout: Layout) -> *mut u8 {
+        count();
+        System.alloc(layout)
+    }
+
+    unsafe fn realloc(&self, ptr: *mut u8, layout: Layout, new_size: usize) -> *mut u8 {
+        count();
+        System.realloc(ptr, layout, new_size)
+    }
+
+    unsafe fn dealloc(&self, ptr: *mut u8, layout: Layout) {
+        System.dealloc(ptr, layout)
+    }
+}
+
+#[global_allocator]
+static ALLOC: CountingAlloc = CountingAlloc;
+
+const CLIENTS: usize = 4;
+const EVENTS: u64 = 1000;
+
+const DEVICE: &str = "Keyball44";
+
+// What the monitor publishes for a layer change on a board it has names
+// for.
+fn layer_message(i: u64) -> SocketMessage {
+    SocketMessage::LayerStatus(LayerStatus {
+        layer_name: Some("🔣"),
+        layer_id: (i % 6) as u8,
+        layer_state: 1 << (i % 6),
+        timestamp: i,
+    })
+}
+
+// Client sockets whose far ends are drained by a thread each, as a status
+// bar would.
+fn clients() -> Vec<UnixStream> {
+    (0..CLIENTS)
+        .map(|_| {
+            let (ours, mut theirs) = UnixStream::pair().unwrap();
+            thread::spawn(move || {
+                let mut buf = [0u8; 4096];
+                while matches!(theirs.read(&mut buf), Ok(n) if n > 0) {}
+            });
+            ours
+        })
+        .collect()
+}
+
+fn owned_event(clients: &mut [UnixStream], i: u64) {
+    let message = layer_message(i);
+    let tagged = TaggedMessage {
+        device_id: 0,
+        device: DEVICE,
+        message: &message,
+    };
+    let json = serde_json::to_string(&tagged).unwrap();
+    for client in clients.iter_mut() {
+        writeln!(client, "{}", json).unwrap();
+    }
+}
+
+fn pooled_broadcaster() -> Arc<Broadcaster> {
+    let broadcaster = Broadcaster::new().unwrap();
+    for client in clients() {
+        broadcaster.add_client(client).unwrap();
+    }
+    // Let the silent clients settle as JSON.
+    thread::sleep(protocol::HELLO_TIMEOUT * 2);
+    broadcaster
+}
+
+fn pooled_event(broadcaster: &Broadcaster, i: u64) {
+    let message = layer_message(i);
+    let tagged = TaggedMessage {
+        device_id: 0,
+        device: DEVICE,
+        message: &message,
+    };
+    let record = BinaryRecord {
+        command: 0x01,
+        layer_id: (i % 6) as u8,
+        device_id: 0,
+        layer_state: 1 << (i % 6),
+        timestamp_ns: i,
+        sequence: i,
+    };
+    broadcaster
+        .publish(|protocol, frame| message::encode(protocol, &tagged, &record, frame))
+        .unwrap();
+}
+
+// Allocations per event on the calling thread. Events are spaced out, as
+// layer changes are, so the writer returns frames to the pool in between.
+fn allocations_per_event(mut event: impl FnMut(u64)) -> f64 {
+    for i in 0..EVENTS {
+        event(i);
+    }
+
+    ALLOCATIONS.store(0, Ordering::Relaxed);
+    for i in 0..EVENTS {
+        COUNTING.with(|c| c.set(true));
+        event(i);
+        COUNTING.with(|c| c.set(false));
+        thread::sleep(Duration::from_micros(200));
+    }
+    ALLOCATIONS.load(Ordering::Relaxed) as f64 / EVENTS as f64
+}
+
+fn bench_broadcast(c: &mut Criterion) {
+    let mut owned_clients = clients();
+    let broadcaster = pooled_broadcaster();
+
+    println!(
+        "allocations per event, {} clients: to_string + writeln {:.2}, pooled frame {:.2}",
+        CLIENTS,
+        allocations_per_event(|i| owned_event(&mut owned_clients, i)),
+        allocations_per_event(|i| pooled_event(&broadcaster, i)),
+    );
+
+    let mut group = c.benchmark_group("broadcast");
+    let mut i = 0;
+    group.bench_function("to_string + writeln", |b| {
+        b.iter(|| {
+            i += 1;
+            owned_event(&mut owned_clients, black_box(i))
+        })
+    });
+    group.bench_function("pooled frame", |b| {
+        b.iter(|| {
+            i += 1;
+            pooled_event(&broadcaster, black_box(i))
+        })
+    });
+    group.finish();
+}
+
+criterion_group!(benches, bench_broadcast);
+criterion_main!(benches);
@@ -0,0 +1,653 @@
+use anyhow::{bail, Context, Result};
+use log::{debug, error, info};
+use std::collections::HashMap;
+use std::io::{self, Read, Write};
+use std::marker::PhantomData;
+use std::os::fd::{AsRawFd, RawFd};
+use std::os::unix::net::UnixStream;
+use std::ptr;
+use std::sync::atomic::{AtomicBool, AtomicPtr, AtomicU64, AtomicU8, AtomicUsize, Ordering};
+use std::sync::{Arc, Mutex};
+use std::thread;
+use std::time::{Duration, Instant};
+
+use crate::protocol::{self, Protocol, BINARY_HELLO, HELLO_TIMEOUT};
+
+// Frames queued per client before the oldest ones start being dropped.
+const CLIENT_QUEUE_FRAMES: usize = 64;
+
+// Serialized frames kept for reuse, and the capacity each one starts with.
+// Comfortably fits any SocketMessage.
+const FRAME_POOL_SIZE: usize = 8;
+const FRAME_CAPACITY: usize = 256;
+
+// epoll token of the eventfd used to wake the writer; clients start at 1.
+const WAKE_TOKEN: u64 = 0;
+
+pub type Frame = Arc<Vec<u8>>;
+
+/// A value readers get at without blocking, replaced as a whole by writers.
+///
+/// Readers announce themselves in `readers` before loading the pointer. A
+/// writer swaps in the new value and then waits for the readers to leave
+/// before it frees the old one. Readers are expected to be brief.
+struct Snapshot<T> {
+    current: AtomicPtr<T>,
+    readers: AtomicUsize,
+    // Serializes writers.
+    update: Mutex<()>,
+    _owns: PhantomData<T>,
+}
+
+impl<T> Snapshot<T> {
+    fn new(value: T) -> Self {
+        Self {
+            current: AtomicPtr::new(Box::into_raw(Box::new(value))),
+            readers: AtomicUsize::new(0),
+            update: Mutex::new(()),
+            _owns: PhantomData,
+        }
+    }
+
+    fn read<R>(&self, f: impl FnOnce(&T) -> R) -> R {
+        self.readers.fetch_add(1, Ordering::SeqCst);
+        let value = unsafe { &*self.current.load(Ordering::SeqCst) };
+        let result = f(value);
+        self.readers.fetch_sub(1, Ordering::Release);
+        result
+    }
+
+    // Must not be called from within `read`, which it would wait for.
+    fn update(&self, f: impl FnOnce(&T) -> T) {
+        let _update = self.update.lock().unwrap();
+        let old = self.current.load(Ordering::SeqCst);
+        let new = Box::into_raw(Box::new(f(unsafe { &*old })));
+        self.current.store(new, Ordering::SeqCst);
+
+        // Anyone who may still see `old` announced themselves before the
+        // store above.
+        while self.readers.load(Ordering::SeqCst) != 0 {
+            thread::yield_now();
+        }
+        drop(unsafe { Box::from_raw(old) });
+    }
+}
+
+impl<T> Drop for Snapshot<T> {
+    fn drop(&mut self) {
+        drop(unsafe { Box::from_raw(*self.current.get_mut()) });
+    }
+}
+
+/// Bounded queue of frames with a single producer, the publisher, and a
+/// single consumer, the writer thread. Neither side takes a lock.
+///
+/// When the ring is full the producer drops the oldest frame by popping it
+/// itself, so popping is a compare-and-swap on `head`. `head` and `tail`
+/// only ever grow, so a pop that lost the race fails instead of taking a
+/// slot refilled since.
+struct Ring {
+    slots: [AtomicPtr<Vec<u8>>; CLIENT_QUEUE_FRAMES],
+    head: AtomicUsize,
+    tail: AtomicUsize,
+}
+
+impl Ring {
+    fn new() -> Self {
+        Self {
+            slots: std::array::from_fn(|_| AtomicPtr::new(ptr::null_mut())),
+            head: AtomicUsize::new(0),
+            tail: AtomicUsize::new(0),
+        }
+    }
+
+    fn len(&self) -> usize {
+        let head = self.head.load(Ordering::Acquire);
+        self.tail.load(Ordering::Acquire).wrapping_sub(head)
+    }
+
+    // Producer only. Returns whether the oldest frame was dropped to make
+    // room.
+    fn push(&self, frame: Frame) -> bool {
+        let tail = self.tail.load(Ordering::Relaxed);
+        let full = tail.wrapping_sub(self.head.load(Ordering::Acquire)) == CLIENT_QUEUE_FRAMES;
+        // Empty only if the consumer made room in the meantime.
+        let dropped = full && self.pop().is_some();
+
+        let slot = &self.slots[tail % CLIENT_QUEUE_FRAMES];
+        slot.store(Arc::into_raw(frame) as *mut Vec<u8>, Ordering::Relaxed);
+        self.tail.store(tail.wrapping_add(1), Ordering::Release);
+        dropped
+    }
+
+    fn pop(&self) -> Option<Frame> {
+        loop {
+            let head = self.head.load(Ordering::Acquire);
+            if head == self.tail.load(Ordering::Acquire) {
+                return None;
+            }
+            // Only valid if the swap below succeeds: the producer refills
+            // this slot only after `head` moved past it.
+            let frame = self.slots[head % CLIENT_QUEUE_FRAMES].load(Ordering::Relaxed);
+            if self
+                .head
+                .compare_exchange(
+                    head,
+                    head.wrapping_add(1),
+                    Ordering::AcqRel,
+                    Ordering::Acquire,
+                )
+                .is_ok()
+            {
+                return Some(unsafe { Arc::from_raw(frame) });
+            }
+        }
+    }
+
+    fn clear(&self) {
+        while self.pop().is_some() {}
+    }
+}
+
+impl Drop for Ring {
+    fn drop(&mut self) {
+        self.clear();
+    }
+}
+
+// Client::protocol values.
+const UNSETTLED: u8 = 0;
+const JSON: u8 = 1;
+const BINARY: u8 = 2;
+
+// The part of a client shared with the publisher.
+struct Client {
+    token: u64,
+    stream: UnixStream,
+    hello_deadline: Instant,
+    // UNSETTLED until the client's hello, or its absence, settles it.
+    protocol: AtomicU8,
+    // While the protocol is unsettled, `frames` gets the JSON frames and
+    // `binary_frames` the binary ones, so the client misses no event
+    // either way.
+    frames: Ring,
+    binary_frames: Ring,
+}
+
+impl Client {
+    fn protocol(&self) -> Option<Protocol> {
+        match self.protocol.load(Ordering::Acquire) {
+            JSON => Some(Protocol::Json),
+            BINARY => Some(Protocol::Binary),
+            _ => None,
+        }
+    }
+
+    // The ring read under `protocol`, which the caller loaded once.
+    fn queue(&self, protocol: Option<Protocol>) -> &Ring {
+        match protocol {
+            Some(Protocol::Binary) => &self.binary_frames,
+            _ => &self.frames,
+        }
+    }
+}
+
+// The part of a client only the writer thread touches.
+struct Connection {
+    client: Arc<Client>,
+    // The frame being written and how much of it the socket took. Popped
+    // off the ring first, so the publisher never drops it halfway through.
+    frame: Option<Frame>,
+    offset: usize,
+    hello: [u8; BINARY_HELLO.len()],
+    hello_len: usize,
+}
+
+impl Connection {
+    fn new(client: Arc<Client>) -> Self {
+        Self {
+            client,
+            frame: None,
+            offset: 0,
+            hello: [0; BINARY_HELLO.len()],
+            hello_len: 0,
+        }
+    }
+
+    fn settle(&mut self, protocol: Protocol) {
+        let value = match protocol {
+            Protocol::Json => JSON,
+            Protocol::Binary => BINARY,
+        };
+        self.client.protocol.store(value, Ordering::Release);
+        self.unused_frames().clear();
+    }
+
+    // The ring the client's protocol does not read. A publish racing with
+    // `settle` may still leave a frame there.
+    fn unused_frames(&self) -> &Ring {
+        match self.client.protocol() {
+            Some(Protocol::Binary) => &self.client.frames,
+            _ => &self.client.binary_frames,
+        }
+    }
+
+    // Reads what the client sent so far towards BINARY_HELLO. Returns the
+    // protocol if this call settled it.
+    fn read_hello(&mut self) -> Option<Protocol> {
+        if self.client.protocol().is_some() {
+            return None;
+        }
+
+        loop {
+            let start = self.hello_len;
+            let protocol = match (&self.client.stream).read(&mut self.hello[start..]) {
+                // Shut down its write side without a hello.
+                Ok(0) => Protocol::Json,
+                Ok(n) => {
+                    self.hello_len += n;
+                    match protocol::sniff(&self.hello[..self.hello_len]) {
+                        Some(protocol) => protocol,
+                        None => continue,
+                    }
+                }
+                Err(e) if e.kind() == io::ErrorKind::WouldBlock => return None,
+                Err(e) if e.kind() == io::ErrorKind::Interrupted => continue,
+                Err(_) => Protocol::Json,
+            };
+            self.settle(protocol);
+            return Some(protocol);
+        }
+    }
+
+    // Writes queued frames until the queue is empty or the socket is full.
+    // Returns false once the client is gone.
+    fn flush(&mut self) -> bool {
+        if self.client.protocol().is_none() {
+            return true;
+        }
+        self.unused_frames().clear();
+
+        loop {
+            let frame = match self.frame.take() {
+                Some(frame) => frame,
+                None => match self.client.queue(self.client.protocol()).pop() {
+                    Some(frame) => frame,
+                    None => return true,
+                },
+            };
+            match (&self.client.stream).write(&frame[self.offset..]) {
+                Ok(n) if self.offset + n == frame.len() => self.offset = 0,
+                Ok(n) => {
+                    self.offset += n;
+                    self.frame = Some(frame);
+                }
+                Err(e) if e.kind() == io::ErrorKind::WouldBlock => {
+                    self.frame = Some(frame);
+                    return true;
+                }
+                Err(e) if e.kind() == io::ErrorKind::Interrupted => self.frame = Some(frame),
+                Err(_) => return false,
+            }
+        }
+    }
+}
+
+#[derive(Default)]
+struct Stats {
+    frames_queued: AtomicU64,
+    frames_dropped: AtomicU64,
+    max_queue_depth: AtomicU64,
+}
+
+/// Fans pre-serialized frames out to every connected client without ever
+/// blocking the caller.
+///
+/// Each client gets a bounded lock-free ring drained by a single
+/// epoll-driven writer thread. A client that stops reading loses its
+/// oldest frames instead of stalling the HID reader or the other clients.
+/// The client list is a snapshot replaced on connect and disconnect, so
+/// publishing takes no lock shared with the writer or the accept thread.
+///
+/// Each event is serialized once into a pooled frame that every client
+/// ring shares by reference count. A frame goes back to the pool once all
+/// clients have written it, so steady-state broadcasting does not allocate.
+///
+/// A new client is registered as soon as it connects. The writer sniffs its
+/// hello from the epoll loop and settles it as JSON once HELLO_TIMEOUT
+/// passes without one; until then it is queued frames of both protocols.
+pub struct Broadcaster {
+    clients: Snapshot<Vec<Arc<Client>>>,
+    // Set when `clients` changed behind the writer's back.
+    clients_changed: AtomicBool,
+    // Only publishers take this.
+    pool: Mutex<Vec<Frame>>,
+    next_token: AtomicU64,
+    epoll_fd: RawFd,
+    wake_fd: RawFd,
+    stats: Stats,
+}
+
+impl Broadcaster {
+    pub fn new() -> Result<Arc<Self>> {
+        let epoll_fd = unsafe { libc::epoll_create1(libc::EPOLL_CLOEXEC) };
+        if epoll_fd < 0 {
+            return Err(io::Error::last_os_error()).context("Failed to create epoll instance");
+        }
+
+        let wake_fd = unsafe { libc::eventfd(0, libc::EFD_CLOEXEC | libc::EFD_NONBLOCK) };
+        if wake_fd < 0 {
+            unsafe { libc::close(epoll_fd) };
+            return Err(io::Error::last_os_error()).context("Failed to create eventfd");
+        }
+
+        let broadcaster = Arc::new(Self {
+            clients: Snapshot::new(Vec::new()),
+            clients_changed: AtomicBool::new(false),
+            pool: Mutex::new(Vec::with_capacity(FRAME_POOL_SIZE)),
+            next_token: AtomicU64::new(WAKE_TOKEN + 1),
+            epoll_fd,
+            wake_fd,
+            stats: Stats::default(),
+        });
+
+        broadcaster.watch(wake_fd, WAKE_TOKEN, libc::EPOLLIN as u32)?;
+
+        let writer = Arc::clone(&broadcaster);
+        thread::Builder::new()
+            .name("broadcast-writer".into())
+            .spawn(move || writer.run_writer())
+            .context("Failed to spawn broadcast writer thread")?;
+
+        Ok(broadcaster)
+    }
+
+    fn watch(&self, fd: RawFd, token: u64, events: u32) -> Result<()> {
+        let mut event = libc::epoll_event { events, u64: token };
+        if unsafe { libc::epoll_ctl(self.epoll_fd, libc::EPOLL_CTL_ADD, fd, &mut event) } < 0 {
+            bail!(
+                "Failed to register fd with epoll: {}",
+                io::Error::last_os_error()
+            );
+        }
+        Ok(())
+    }
+
+    pub fn add_client(&self, stream: UnixStream) -> Result<()> {
+        stream
+            .set_nonblocking(true)
+            .context("Failed to make client socket non-blocking")?;
+
+        let token = self.next_token.fetch_add(1, Ordering::Relaxed);
+        let client = Arc::new(Client {
+            token,
+            stream,
+            hello_deadline: Instant::now() + HELLO_TIMEOUT,
+            protocol: AtomicU8::new(UNSETTLED),
+            frames: Ring::new(),
+            binary_frames: Ring::new(),
+        });
+        // Registered before it is watched, so the writer finds it when the
+        // hello has already arrived.
+        self.clients.update(|clients| {
+            let mut clients = clients.clone();
+            clients.push(Arc::clone(&client));
+            clients
+        });
+        self.clients_changed.store(true, Ordering::Release);
+
+        // Only a hangup or a failed write drops a client. Read-only clients
+        // that shut down their write side still get every frame.
+        let events = (libc::EPOLLIN | libc::EPOLLOUT | libc::EPOLLET) as u32;
+        let watched = self.watch(client.stream.as_raw_fd(), token, events);
+        if watched.is_err() {
+            self.forget(token);
+        }
+
+        // Wake the writer so it arms the hello deadline.
+        self.wake();
+        watched
+    }
+
+    fn forget(&self, token: u64) {
+        self.clients.update(|clients| {
+            clients
+                .iter()
+                .filter(|client| client.token != token)
+                .cloned()
+                .collect()
+        });
+        self.clients_changed.store(true, Ordering::Release);
+    }
+
+    // Serializes into a pooled frame nobody else holds any more, falling
+    // back to a fresh allocation when every pooled frame is still queued.
+    fn frame(&self, serialize: impl FnOnce(&mut Vec<u8>) -> Result<()>) -> Result<Frame> {
+        let mut pool = self.pool.lock().unwrap();
+
+        let slot = match pool.iter_mut().position(|f| Arc::get_mut(f).is_some()) {
+            Some(slot) => slot,
+            None if pool.len() < FRAME_POOL_SIZE => {
+                pool.push(Arc::new(Vec::with_capacity(FRAME_CAPACITY)));
+                pool.len() - 1
+            }
+            None => {
+                let mut buf = Vec::with_capacity(FRAME_CAPACITY);
+                serialize(&mut buf)?;
+                return Ok(Arc::new(buf));
+            }
+        };
+
+        let buf = Arc::get_mut(&mut pool[slot]).expect("pooled frame is unshared");
+        buf.clear();
+        serialize(buf)?;
+        Ok(Arc::clone(&pool[slot]))
+    }
+
+    /// Serializes one event with `serialize`, queues it for every client and
+    /// wakes the writer. The event is serialized at most once per protocol,
+    /// and only for protocols some connected client speaks.
+    pub fn publish(&self, serialize: impl Fn(Protocol, &mut Vec<u8>) -> Result<()>) -> Result<()> {
+        let published = self.clients.read(|clients| -> Result<bool> {
+            if clients.is_empty() {
+                return Ok(false);
+            }
+
+            let mut json = None;
+            let mut binary = None;
+            let mut frame_for = |protocol: Protocol| -> Result<Frame> {
+                let slot = match protocol {
+                    Protocol::Json => &mut json,
+                    Protocol::Binary => &mut binary,
+                };
+                let frame = match slot {
+                    Some(frame) => frame,
+                    None => slot.insert(self.frame(|buf| serialize(protocol, buf))?),
+                };
+                Ok(Arc::clone(frame))
+            };
+
+            for client in clients {
+                let protocol = client.protocol();
+                if protocol.is_none() {
+                    client.binary_frames.push(frame_for(Protocol::Binary)?);
+                }
+
+                let queue = client.queue(protocol);
+                if queue.push(frame_for(protocol.unwrap_or(Protocol::Json))?) {
+                    self.stats.frames_dropped.fetch_add(1, Ordering::Relaxed);
+                }
+                self.stats
+                    .max_queue_depth
+                    .fetch_max(queue.len() as u64, Ordering::Relaxed);
+                self.stats.frames_queued.fetch_add(1, Ordering::Relaxed);
+            }
+            Ok(true)
+        })?;
+
+        if published {
+            self.wake();
+        }
+        Ok(())
+    }
+
+    fn wake(&self) {
+        let one: u64 = 1;
+        unsafe { libc::write(self.wake_fd, &one as *const u64 as *const libc::c_void, 8) };
+    }
+
+    fn run_writer(&self) {
+        let mut events = [libc::epoll_event { events: 0, u64: 0 }; 16];
+        let mut connections = HashMap::new();
+
+        loop {
+            let timeout = self.expire_hellos(&mut connections);
+            let n = unsafe {
+                libc::epoll_wait(
+                    self.epoll_fd,
+                    events.as_mut_ptr(),
+                    events.len() as i32,
+                    timeout,
+                )
+            };
+            if n < 0 {
+                let err = io::Error::last_os_error();
+                if err.kind() != io::ErrorKind::Interrupted {
+                    error!("epoll_wait failed: {}", err);
+                    return;
+                }
+                continue;
+            }
+
+            if self.clients_changed.swap(false, Ordering::Acquire) {
+                self.sync_connections(&mut connections);
+            }
+
+            for event in &events[..n as usize] {
+                let token = event.u64;
+                if token == WAKE_TOKEN {
+                    let mut counter: u64 = 0;
+                    unsafe {
+                        libc::read(
+                            self.wake_fd,
+                            &mut counter as *mut u64 as *mut libc::c_void,
+                            8,
+                        )
+                    };
+                    self.flush_all(&mut connections);
+                    continue;
+                }
+
+                let hangup = (libc::EPOLLHUP | libc::EPOLLERR) as u32;
+                if event.events & hangup != 0 {
+                    self.remove_client(&mut connections, token);
+                    continue;
+                }
+
+                if let Some(connection) = connections.get_mut(&token) {
+                    if event.events & libc::EPOLLIN as u32 != 0 {
+                        if let Some(protocol) = connection.read_hello() {
+                            info!("Client {} speaks {:?}", token, protocol);
+                        }
+                    }
+                    if !connection.flush() {
+                        self.remove_client(&mut connections, token);
+                    }
+                }
+            }
+        }
+    }
+
+    // Brings the writer's connections in line with the client snapshot.
+    fn sync_connections(&self, connections: &mut HashMap<u64, Connection>) {
+        self.clients.read(|clients| {
+            connections.retain(|token, _| clients.iter().any(|c| c.token == *token));
+            for client in clients {
+                connections
+                    .entry(client.token)
+                    .or_insert_with(|| Connection::new(Arc::clone(client)));
+            }
+        });
+    }
+
+    // Settles clients whose hello deadline passed as JSON, flushing what
+    // was queued for them. Returns the epoll_wait timeout until the next
+    // deadline, or -1 while no client is unsettled.
+    fn expire_hellos(&self, connections: &mut HashMap<u64, Connection>) -> i32 {
+        let now = Instant::now();
+        let mut next: Option<Duration> = None;
+        let mut gone = Vec::new();
+
+        for (token, connection) in connections.iter_mut() {
+            let client = &connection.client;
+            if client.protocol().is_some() {
+                continue;
+            }
+            if client.hello_deadline > now {
+                let left = client.hello_deadline - now;
+                next = Some(next.map_or(left, |next| next.min(left)));
+                continue;
+            }
+
+            connection.settle(Protocol::Json);
+            info!("Client {} speaks {:?}", token, Protocol::Json);
+            if !connection.flush() {
+                gone.push(*token);
+            }
+        }
+        for token in gone {
+            self.remove_client(connections, token);
+        }
+
+        // Rounded up, so the deadline has passed once epoll_wait returns.
+        next.map_or(-1, |next| next.as_millis() as i32 + 1)
+    }
+
+    fn flush_all(&self, connections: &mut HashMap<u64, Connection>) {
+        let gone: Vec<u64> = connections
+            .iter_mut()
+            .filter_map(|(token, connection)| (!connection.flush()).then_some(*token))
+            .collect();
+        for token in gone {
+            self.remove_client(connections, token);
+        }
+    }
+
+    fn remove_client(&self, connections: &mut HashMap<u64, Connection>, token: u64) {
+        if let Some(connection) = connections.remove(&token) {
+            unsafe {
+                libc::epoll_ctl(
+                    self.epoll_fd,
+                    libc::EPOLL_CTL_DEL,
+                    connection.client.stream.as_raw_fd(),
+                    ptr::null_mut(),
+                )
+            };
+            self.forget(token);
+            debug!("Client disconnected");
+        }
+    }
+
+    pub fn dump_stats(&self) {
+        self.clients.read(|clients| {
+            info!(
+                "Broadcast: {} clients, {} frames queued, {} dropped, max queue depth {}/{}",
+                clients.len(),
+                self.stats.frames_queued.load(Ordering::Relaxed),
+                self.stats.frames_dropped.load(Ordering::Relaxed),
+                self.stats.max_queue_depth.load(Ordering::Relaxed),
+                CLIENT_QUEUE_FRAMES
+            );
+            for client in clients {
+                info!(
+                    "  client {} ({}): queue depth {}",
+                    client.token,
+                    client
+                        .protocol()
+                        .map_or("negotiating".into(), |p| format!("{:?}", p)),
+                    client.queue(client.protocol()).len()
+                );
+            }
+        });
+    }
+}
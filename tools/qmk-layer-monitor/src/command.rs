@@ -0,0 +1,107 @@
+use anyhow::{bail, Result};
+use hidapi::{DeviceInfo, HidApi};
+use std::time::{Duration, Instant};
+
+use crate::request::{Request, Requests, Response, Status};
+use crate::{device_name, HidCommand, PACKET_SIZE, USAGE, USAGE_PAGE};
+
+// How long a board gets to answer before it is reported as silent.
+const RESPONSE_TIMEOUT: Duration = Duration::from_millis(500);
+
+/// A request sent once to every connected board instead of monitoring,
+/// e.g. `--set-layer 2`. Works alongside a running monitor, since every
+/// reader of a hidraw node sees every report.
+#[derive(Debug, Clone, Copy)]
+pub struct Command {
+    pub request: Request,
+    pub arg: Option<u8>,
+}
+
+pub fn run(command: Command) -> Result<()> {
+    let api = HidApi::new()?;
+    let mut boards = 0;
+    let mut failed = 0;
+
+    for info in api
+        .device_list()
+        .filter(|d| d.usage_page() == USAGE_PAGE && d.usage() == USAGE)
+    {
+        boards += 1;
+        match send(&api, info, command) {
+            Ok(result) => println!("{}: {}", device_name(info), result),
+            Err(e) => {
+                println!("{}: {}", device_name(info), e);
+                failed += 1;
+            }
+        }
+    }
+
+    if boards == 0 {
+        bail!("No QMK raw HID devices found");
+    }
+    if failed > 0 {
+        bail!(
+            "{:?} failed on {} of {} boards",
+            command.request,
+            failed,
+            boards
+        );
+    }
+    Ok(())
+}
+
+fn send(api: &HidApi, info: &DeviceInfo, command: Command) -> Result<String> {
+    let device = info.open_device(api)?;
+    let mut requests = Requests::default();
+    let args = match &command.arg {
+        Some(arg) => std::slice::from_ref(arg),
+        None => &[],
+    };
+    requests.send(&device, command.request, args)?;
+
+    // Layer changes and other reports keep arriving in the meantime.
+    let deadline = Instant::now() + RESPONSE_TIMEOUT;
+    let mut buffer = [0u8; PACKET_SIZE];
+    loop {
+        let left = deadline.saturating_duration_since(Instant::now());
+        if left.is_zero() {
+            bail!("No response; firmware built without RAW_ENABLE?");
+        }
+        let read = device.read_timeout(&mut buffer, left.as_millis().max(1) as i32)?;
+        if read != PACKET_SIZE || buffer[0] != HidCommand::Response as u8 {
+            continue;
+        }
+        if let Some(response) = requests.complete(&buffer) {
+            return describe(&response);
+        }
+    }
+}
+
+fn describe(response: &Response) -> Result<String> {
+    match response.status {
+        Some(Status::Ok) => {}
+        Some(Status::UnknownRequest) => bail!("{:?} not supported", response.request),
+        status => bail!("{:?} failed: {:?}", response.request, status),
+    }
+
+    let payload = response.payload;
+    Ok(match response.request {
+        Request::GetState | Request::SetLayer => format!(
+            "Layer: {}, State: 0x{:08x}",
+            payload[1],
+            u32::from_le_bytes([payload[3], payload[4], payload[5], payload[6]])
+        ),
+        Request::GetPointer => format!(
+            "CPI: {}, Scroll div: {}, Scroll: {}",
+            payload[0] as u32 * 100,
+            payload[1],
+            payload[2] != 0
+        ),
+        Request::Save => "Settings saved".to_string(),
+        Request::ReadQueue => format!(
+            "Output queue depth: {}, max: {}, dropped: {}",
+            payload[0], payload[1], payload[2]
+        ),
+        Request::ReadTrace => format!("{:02x?}", payload),
+    })
+}
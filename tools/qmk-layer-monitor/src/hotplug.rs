@@ -0,0 +1,277 @@
+use anyhow::{Context, Result};
+use log::{debug, info};
+use std::fs;
+use std::io;
+use std::mem::size_of;
+use std::os::fd::{AsRawFd, FromRawFd, OwnedFd};
+
+use crate::{USAGE, USAGE_PAGE};
+
+// Kernel uevent multicast group; delivered without udevd running.
+const UEVENT_KERNEL_GROUP: u32 = 1;
+
+enum Source {
+    Netlink,
+    Inotify,
+}
+
+/// Wakes the monitor when a QMK raw HID node appears, so it only
+/// enumerates HID devices when something actually changed. Other HID
+/// devices coming and going (mice, headsets, ...) are ignored by looking at
+/// the report descriptor the kernel publishes for each node in sysfs.
+///
+/// Listens for kernel uevents over netlink and falls back to watching /dev
+/// with inotify where netlink sockets are not permitted.
+pub struct Hotplug {
+    fd: OwnedFd,
+    source: Source,
+}
+
+impl Hotplug {
+    pub fn new() -> Result<Self> {
+        match open_netlink() {
+            Ok(fd) => {
+                info!("Watching for HID devices via netlink uevents");
+                return Ok(Self {
+                    fd,
+                    source: Source::Netlink,
+                });
+            }
+            Err(e) => debug!("Netlink uevents unavailable: {}", e),
+        }
+
+        let fd = open_inotify().context("Failed to watch /dev for hidraw devices")?;
+        info!("Watching for HID devices via inotify on /dev");
+        Ok(Self {
+            fd,
+            source: Source::Inotify,
+        })
+    }
+
+    /// Blocks until a QMK raw HID device appears or, with inotify, has its
+    /// permissions changed.
+    pub fn wait(&self) -> Result<()> {
+        loop {
+            self.poll()?;
+            if self.read_events()? {
+                return Ok(());
+            }
+        }
+    }
+
+    fn poll(&self) -> Result<()> {
+        let mut pfd = libc::pollfd {
+            fd: self.fd.as_raw_fd(),
+            events: libc::POLLIN,
+            revents: 0,
+        };
+
+        loop {
+            match unsafe { libc::poll(&mut pfd, 1, -1) } {
+                n if n >= 0 => return Ok(()),
+                _ => {
+                    let err = io::Error::last_os_error();
+                    if err.kind() != io::ErrorKind::Interrupted {
+                        return Err(err).context("Failed to poll hotplug events");
+                    }
+                }
+            }
+        }
+    }
+
+    // Reads everything currently queued and reports whether it contained a
+    // raw HID device being added.
+    fn read_events(&self) -> Result<bool> {
+        let mut buf = [0u8; 8192];
+        let mut added = false;
+
+        loop {
+            let n = unsafe {
+                libc::read(
+                    self.fd.as_raw_fd(),
+                    buf.as_mut_ptr() as *mut libc::c_void,
+                    buf.len(),
+                )
+            };
+            if n < 0 {
+                let err = io::Error::last_os_error();
+                match err.raw_os_error() {
+                    Some(libc::EAGAIN) => return Ok(added),
+                    Some(libc::EINTR) => continue,
+                    // Events were lost; assume one of them mattered.
+                    Some(libc::ENOBUFS) => added = true,
+                    _ => return Err(err).context("Failed to read hotplug events"),
+                }
+                continue;
+            }
+
+            let events = &buf[..n as usize];
+            added |= match self.source {
+                Source::Netlink => hidraw_add_uevent(events).is_some_and(is_raw_hid),
+                Source::Inotify => hidraw_inotify_events(events).any(is_raw_hid),
+            };
+        }
+    }
+}
+
+fn open_netlink() -> io::Result<OwnedFd> {
+    let fd = unsafe {
+        libc::socket(
+            libc::AF_NETLINK,
+            libc::SOCK_DGRAM | libc::SOCK_NONBLOCK | libc::SOCK_CLOEXEC,
+            libc::NETLINK_KOBJECT_UEVENT,
+        )
+    };
+    if fd < 0 {
+        return Err(io::Error::last_os_error());
+    }
+    let fd = unsafe { OwnedFd::from_raw_fd(fd) };
+
+    let mut addr: libc::sockaddr_nl = unsafe { std::mem::zeroed() };
+    addr.nl_family = libc::AF_NETLINK as libc::sa_family_t;
+    addr.nl_groups = UEVENT_KERNEL_GROUP;
+
+    let ret = unsafe {
+        libc::bind(
+            fd.as_raw_fd(),
+            &addr as *const libc::sockaddr_nl as *const libc::sockaddr,
+            size_of::<libc::sockaddr_nl>() as libc::socklen_t,
+        )
+    };
+    if ret < 0 {
+        return Err(io::Error::last_os_error());
+    }
+
+    Ok(fd)
+}
+
+fn open_inotify() -> io::Result<OwnedFd> {
+    let fd = unsafe { libc::inotify_init1(libc::IN_NONBLOCK | libc::IN_CLOEXEC) };
+    if fd < 0 {
+        return Err(io::Error::last_os_error());
+    }
+    let fd = unsafe { OwnedFd::from_raw_fd(fd) };
+
+    // IN_ATTRIB catches udev fixing up permissions after the node appears.
+    let mask = libc::IN_CREATE | libc::IN_ATTRIB;
+    if unsafe { libc::inotify_add_watch(fd.as_raw_fd(), c"/dev".as_ptr(), mask) } < 0 {
+        return Err(io::Error::last_os_error());
+    }
+
+    Ok(fd)
+}
+
+// A kernel uevent is "ACTION@DEVPATH" followed by NUL-separated KEY=VALUE
+// pairs, one message per datagram. Returns the node name of a hidraw
+// device being added.
+fn hidraw_add_uevent(msg: &[u8]) -> Option<&[u8]> {
+    let mut add = false;
+    let mut hidraw = false;
+    let mut name = None;
+
+    for field in msg.split(|&b| b == 0) {
+        match field {
+            b"ACTION=add" => add = true,
+            b"SUBSYSTEM=hidraw" => hidraw = true,
+            _ => {
+                if let Some(value) = field.strip_prefix(b"DEVNAME=") {
+                    name = Some(value);
+                }
+            }
+        }
+    }
+
+    if add && hidraw {
+        name
+    } else {
+        None
+    }
+}
+
+// Names of the hidraw nodes that were created or changed in /dev.
+fn hidraw_inotify_events(mut events: &[u8]) -> impl Iterator<Item = &[u8]> {
+    let header = size_of::<libc::inotify_event>();
+
+    std::iter::from_fn(move || {
+        while events.len() >= header {
+            let event: libc::inotify_event =
+                unsafe { std::ptr::read_unaligned(events.as_ptr() as *const _) };
+            let len = header + event.len as usize;
+            if events.len() < len {
+                break;
+            }
+            // The name is NUL-padded.
+            let name = &events[header..len];
+            let name = &name[..name.iter().position(|&b| b == 0).unwrap_or(name.len())];
+            events = &events[len..];
+            if name.starts_with(b"hidraw") {
+                return Some(name);
+            }
+        }
+        None
+    })
+}
+
+// Whether the hidraw node `name` is a QMK raw HID interface. A node whose
+// descriptor cannot be read counts as one, so nothing is missed.
+fn is_raw_hid(name: &[u8]) -> bool {
+    let Ok(name) = std::str::from_utf8(name) else {
+        return true;
+    };
+    let name = name.trim_start_matches("/dev/");
+    let path = format!("/sys/class/hidraw/{}/device/report_descriptor", name);
+    match fs::read(path) {
+        Ok(descriptor) => has_usage(&descriptor, USAGE_PAGE, USAGE),
+        Err(e) => {
+            debug!("Failed to read the descriptor of {}: {}", name, e);
+            true
+        }
+    }
+}
+
+// Walks the items of a HID report descriptor looking for `usage` on
+// `usage_page`.
+fn has_usage(mut descriptor: &[u8], usage_page: u16, usage: u16) -> bool {
+    let mut page = 0;
+
+    while let Some(&prefix) = descriptor.first() {
+        // Long items: a size byte, a tag byte, then the data.
+        if prefix == 0xFE {
+            let size = descriptor.get(1).copied().unwrap_or(0) as usize;
+            descriptor = descriptor.get(3 + size..).unwrap_or_default();
+            continue;
+        }
+
+        let size = match prefix & 0x03 {
+            3 => 4,
+            size => size as usize,
+        };
+        let Some(data) = descriptor.get(1..1 + size) else {
+            break;
+        };
+        let value = data
+            .iter()
+            .rev()
+            .fold(0u32, |value, &b| value << 8 | b as u32);
+
+        match prefix & 0xFC {
+            // Usage Page (global)
+            0x04 => page = value as u16,
+            // Usage (local); four bytes carry their own page.
+            0x08 if size == 4 => {
+                if value == (usage_page as u32) << 16 | usage as u32 {
+                    return true;
+                }
+            }
+            0x08 => {
+                if page == usage_page && value == usage as u32 {
+                    return true;
+                }
+            }
+            _ => {}
+        }
+        descriptor = &descriptor[1 + size..];
+    }
+
+    false
+}
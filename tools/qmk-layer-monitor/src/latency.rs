@@ -0,0 +1,67 @@
+use log::info;
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::time::Duration;
+
+// Power-of-two microsecond buckets: [0, 2us), [2us, 4us), ... up to ~8s.
+const BUCKETS: usize = 24;
+
+/// Time from a HID report being read off the device to its broadcast
+/// having been handed to every client.
+pub struct LatencyHistogram {
+    buckets: [AtomicU64; BUCKETS],
+    count: AtomicU64,
+    total_ns: AtomicU64,
+    max_ns: AtomicU64,
+}
+
+impl LatencyHistogram {
+    pub fn new() -> Self {
+        Self {
+            buckets: [const { AtomicU64::new(0) }; BUCKETS],
+            count: AtomicU64::new(0),
+            total_ns: AtomicU64::new(0),
+            max_ns: AtomicU64::new(0),
+        }
+    }
+
+    pub fn record(&self, latency: Duration) {
+        let ns = latency.as_nanos().min(u64::MAX as u128) as u64;
+        let us = ns / 1_000;
+        let bucket = if us < 2 {
+            0
+        } else {
+            (63 - us.leading_zeros() as usize).min(BUCKETS - 1)
+        };
+
+        self.buckets[bucket].fetch_add(1, Ordering::Relaxed);
+        self.count.fetch_add(1, Ordering::Relaxed);
+        self.total_ns.fetch_add(ns, Ordering::Relaxed);
+        self.max_ns.fetch_max(ns, Ordering::Relaxed);
+    }
+
+    pub fn dump(&self) {
+        let count = self.count.load(Ordering::Relaxed);
+        if count == 0 {
+            info!("Latency: no packets recorded yet");
+            return;
+        }
+
+        let total_ns = self.total_ns.load(Ordering::Relaxed);
+        let max_ns = self.max_ns.load(Ordering::Relaxed);
+        info!(
+            "Latency: {} packets, avg {:.1}us, max {:.1}us",
+            count,
+            total_ns as f64 / count as f64 / 1_000.0,
+            max_ns as f64 / 1_000.0
+        );
+
+        for (i, bucket) in self.buckets.iter().enumerate() {
+            let n = bucket.load(Ordering::Relaxed);
+            if n == 0 {
+                continue;
+            }
+            let upper_us = 2u64 << i;
+            info!("  < {:>8}us: {}", upper_us, n);
+        }
+    }
+}
@@ -1,67 +1,125 @@
-use anyhow::{Context, Result};
-use hidapi::{HidApi, HidDevice};
+use anyhow::{bail, Context, Result};
+use hidapi::{DeviceInfo, HidApi, HidDevice};
 use log::{debug, error, info, warn};
-use serde::Serialize;
+use qmk_layer_state::StateWriter;
+use std::ffi::CString;
 use std::fs;
-use std::io::Write;
-use std::os::unix::net::{UnixListener, UnixStream};
-use std::sync::{Arc, Mutex};
+use std::os::unix::net::UnixListener;
+use std::path::PathBuf;
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::{mpsc, Arc};
 use std::thread;
 use std::time::{Duration, Instant};
 
-// Keyball44
-const VENDOR_ID: u16 = 0x5957;
-const PRODUCT_ID: u16 = 0x0400;
+mod broadcast;
+mod command;
+mod hotplug;
+mod latency;
+mod message;
+mod protocol;
+mod request;
+mod trace;
+
+use broadcast::Broadcaster;
+use command::Command;
+use hotplug::Hotplug;
+use latency::LatencyHistogram;
+use message::{LayerStatus, SocketMessage, TaggedMessage};
+use protocol::BinaryRecord;
+use request::{Request, Requests, Status};
+use trace::KeyTrace;
+
+// QMK raw HID interface, exposed by every board built with RAW_ENABLE.
 const USAGE_PAGE: u16 = 0xFF60;
 const USAGE: u16 = 0x61;
 const PACKET_SIZE: usize = 32;
 
+// Without hotplug events, how often to look for new devices.
+const RECONNECT_INTERVAL: Duration = Duration::from_secs(3);
+// After a QMK raw HID node appears, how long to keep rescanning while udev
+// is still setting it up, and how often. Nodes of other HID devices never
+// start this.
+const HOTPLUG_SETTLE_TIME: Duration = Duration::from_secs(2);
+const HOTPLUG_RETRY_INTERVAL: Duration = Duration::from_millis(50);
+// How often to drain key trace records while tracing. A board buffers 32
+// records by default, so this keeps up with fast typing.
+const TRACE_POLL_INTERVAL: Duration = Duration::from_millis(100);
+
 #[repr(u8)]
 #[derive(Debug, Clone, Copy, PartialEq)]
 enum HidCommand {
     LayerStatus = 0x01,
     FavoriteTrack = 0x02,
     WindowHints = 0x03,
+    StateReport = 0x04,
+    Response = 0x05,
+    HookTiming = 0x06,
 }
 
-#[derive(Debug, Clone, Serialize)]
-pub struct LayerStatus {
-    #[serde(rename = "name")]
-    pub layer_name: String,
-    #[serde(rename = "id")]
-    pub layer_id: u8,
-    #[serde(rename = "state")]
-    pub layer_state: u32,
-    pub timestamp: u64,
+const STATE_REPORT_VERSION: u8 = 1;
+
+impl SocketMessage {
+    fn to_record(&self, device_id: u8, timestamp_ns: u64, sequence: u64) -> BinaryRecord {
+        let (command, layer_id, layer_state) = match self {
+            SocketMessage::LayerStatus(status) => {
+                (HidCommand::LayerStatus, status.layer_id, status.layer_state)
+            }
+            SocketMessage::FavoriteTrack { .. } => (HidCommand::FavoriteTrack, 0, 0),
+            SocketMessage::WindowHints { .. } => (HidCommand::WindowHints, 0, 0),
+        };
+
+        BinaryRecord {
+            command: command as u8,
+            layer_id,
+            device_id,
+            layer_state,
+            timestamp_ns,
+            sequence,
+        }
+    }
 }
 
-#[derive(Debug, Clone, Serialize)]
-#[serde(tag = "action", content = "data")]
-pub enum SocketMessage {
-    #[serde(rename = "layer_status")]
-    LayerStatus(LayerStatus),
-    #[serde(rename = "favorite_track")]
-    FavoriteTrack { timestamp: u64 },
-    #[serde(rename = "window_hints")]
-    WindowHints { timestamp: u64 },
+// Layer names for boards whose keymap is known, by USB vendor and product
+// id. Layer numbers mean different things on every keymap, so other boards
+// only report the number.
+const LAYER_NAMES: &[(u16, u16, &[&str])] = &[(
+    0x5957,
+    0x0400, // Keyball44
+    &[
+        "🔤", // Base layer
+        "🔣", // Symbols & Navigation
+        "🔢", // Numbers & Arrows
+        "🖲️", // RGB & Mouse controls (scroll)
+        "🖱️", // Mouse buttons
+        "🎵", // Media, miscellaneous
+    ],
+)];
+
+fn layer_names(vendor_id: u16, product_id: u16) -> &'static [&'static str] {
+    LAYER_NAMES
+        .iter()
+        .find(|(vid, pid, _)| *vid == vendor_id && *pid == product_id)
+        .map_or(&[], |(_, _, names)| names)
 }
 
-fn layer_name(id: u8) -> &'static str {
-    match id {
-        0 => "🔤",    // Base layer
-        1 => "🔣",    // Symbols & Navigation
-        2 => "🔢",    // Numbers & Arrows
-        3 => "🖲️",    // RGB & Mouse controls (scroll)
-        4 => "🖱️",    // Mouse buttons
-        5 => "🎵",    // Media, miscellaneous
-        _ => "❓",
+fn layer_name(board: &Board, id: u8) -> Option<&'static str> {
+    if board.layer_names.is_empty() {
+        return None;
     }
+    Some(board.layer_names.get(id as usize).copied().unwrap_or("❓"))
 }
 
+fn device_name(info: &DeviceInfo) -> String {
+    match info.product_string() {
+        Some(product) if !product.is_empty() => product.to_owned(),
+        _ => format!("{:04x}:{:04x}", info.vendor_id(), info.product_id()),
+    }
+}
 
 struct SocketServer {
-    clients: Arc<Mutex<Vec<UnixStream>>>,
+    broadcaster: Arc<Broadcaster>,
     socket_path: String,
+    sequence: AtomicU64,
 }
 
 impl SocketServer {
@@ -71,8 +129,9 @@ impl SocketServer {
         let _ = fs::remove_file(&socket_path);
 
         let server = Self {
-            clients: Arc::new(Mutex::new(Vec::new())),
+            broadcaster: Broadcaster::new()?,
             socket_path,
+            sequence: AtomicU64::new(0),
         };
 
         Ok(server)
@@ -84,14 +143,15 @@ impl SocketServer {
 
         info!("Unix socket server listening on: {}", self.socket_path);
 
-        let clients = Arc::clone(&self.clients);
+        let broadcaster = Arc::clone(&self.broadcaster);
         thread::spawn(move || {
             for stream in listener.incoming() {
                 match stream {
                     Ok(stream) => {
                         info!("New client connected");
-                        let mut clients = clients.lock().unwrap();
-                        clients.push(stream);
+                        if let Err(e) = broadcaster.add_client(stream) {
+                            error!("Failed to register client: {}", e);
+                        }
                     }
                     Err(e) => {
                         error!("Failed to accept connection: {}", e);
@@ -103,18 +163,21 @@ impl SocketServer {
         Ok(())
     }
 
-    fn broadcast(&self, message: &str) {
-        let mut clients = self.clients.lock().unwrap();
-        clients.retain_mut(|client| match writeln!(client, "{}", message) {
-            Ok(_) => {
-                debug!("Sent to client: {}", message);
-                true
-            }
-            Err(_) => {
-                debug!("Client disconnected");
-                false
-            }
-        });
+    fn broadcast(&self, board: &Board, message: &SocketMessage) -> Result<()> {
+        debug!("Broadcasting from {}: {:?}", board.name, message);
+        let record = message.to_record(
+            board.id,
+            protocol::monotonic_ns(),
+            self.sequence.fetch_add(1, Ordering::Relaxed),
+        );
+        let tagged = TaggedMessage {
+            device_id: board.id,
+            device: &board.name,
+            message,
+        };
+
+        self.broadcaster
+            .publish(|protocol, frame| message::encode(protocol, &tagged, &record, frame))
     }
 }
 
@@ -124,10 +187,42 @@ impl Drop for SocketServer {
     }
 }
 
+type DeviceId = u8;
+
+/// A board exposing the QMK raw HID interface. Its id stays the same across
+/// reconnects for the lifetime of the process.
+struct Board {
+    id: DeviceId,
+    name: String,
+    vendor_id: u16,
+    product_id: u16,
+    serial: Option<String>,
+    layer_names: &'static [&'static str],
+    // Set while a reader thread owns the device.
+    path: Option<CString>,
+    last_layer_id: Option<u8>,
+    // Second handle to the device for sending requests while the reader
+    // thread blocks on the first.
+    writer: Option<HidDevice>,
+    requests: Requests,
+    // Whether to drain key trace records from this board.
+    tracing: bool,
+}
+
+impl Board {
+    fn send_request(&mut self, request: Request, args: &[u8]) -> Result<()> {
+        match &self.writer {
+            Some(writer) => self.requests.send(writer, request, args),
+            None => Ok(()),
+        }
+    }
+}
+
 fn handle_layer_status(
     buffer: &[u8],
+    board: &mut Board,
     socket_server: &SocketServer,
-    last_layer_id: &mut Option<u8>,
+    state_writer: &mut StateWriter,
 ) -> Result<()> {
     if buffer.len() < 4 {
         return Ok(());
@@ -136,12 +231,133 @@ fn handle_layer_status(
     let layer_id = buffer[1];
     let layer_state = u32::from_le_bytes([buffer[2], buffer[3], 0, 0]);
 
-    if Some(layer_id) == *last_layer_id {
+    update_layer(layer_id, layer_state, board, socket_server, state_writer)
+}
+
+// Coalesced report sent by firmware that batches everything that changed
+// within a USB frame. See send_state_report in the keyball44 keymap.
+fn handle_state_report(
+    buffer: &[u8],
+    board: &mut Board,
+    socket_server: &SocketServer,
+    state_writer: &mut StateWriter,
+) -> Result<()> {
+    handle_state_payload(&buffer[1..], board, socket_server, state_writer)
+}
+
+// State payload shared by state reports and GetState/SetLayer responses.
+fn handle_state_payload(
+    payload: &[u8],
+    board: &mut Board,
+    socket_server: &SocketServer,
+    state_writer: &mut StateWriter,
+) -> Result<()> {
+    if payload.len() < 10 {
+        return Ok(());
+    }
+    if payload[0] != STATE_REPORT_VERSION {
+        debug!("{}: Unsupported state version {}", board.name, payload[0]);
+        return Ok(());
+    }
+
+    let layer_id = payload[1];
+    let layer_state = u32::from_le_bytes([payload[3], payload[4], payload[5], payload[6]]);
+
+    debug!(
+        "{}: Mods: 0x{:02x}, CPI: {}, Scroll: {} (div {})",
+        board.name,
+        payload[2],
+        payload[7] as u32 * 100,
+        payload[8] != 0,
+        payload[9]
+    );
+
+    update_layer(layer_id, layer_state, board, socket_server, state_writer)
+}
+
+fn handle_response(
+    buffer: &[u8],
+    board: &mut Board,
+    socket_server: &SocketServer,
+    state_writer: &mut StateWriter,
+    trace: &mut Option<KeyTrace>,
+) -> Result<()> {
+    let Some(response) = board.requests.complete(buffer) else {
+        debug!("{}: Unexpected response: {:02x?}", board.name, &buffer[..4]);
+        return Ok(());
+    };
+
+    if response.request == Request::ReadTrace && response.status == Some(Status::UnknownRequest) {
+        info!("{}: Firmware built without KEY_TRACE_ENABLE", board.name);
+        board.tracing = false;
+        return Ok(());
+    }
+
+    if response.status != Some(Status::Ok) {
+        warn!(
+            "{}: {:?} failed: {:?} (0x{:02x})",
+            board.name, response.request, response.status, buffer[3]
+        );
+        return Ok(());
+    }
+
+    match response.request {
+        Request::GetState | Request::SetLayer => {
+            handle_state_payload(response.payload, board, socket_server, state_writer)
+        }
+        Request::GetPointer => {
+            debug!(
+                "{}: CPI: {}, Scroll div: {}, Scroll: {}",
+                board.name,
+                response.payload[0] as u32 * 100,
+                response.payload[1],
+                response.payload[2] != 0
+            );
+            Ok(())
+        }
+        Request::Save => {
+            info!("{}: Settings saved", board.name);
+            Ok(())
+        }
+        Request::ReadQueue => {
+            debug!(
+                "{}: Output queue depth: {}, max: {}, dropped: {}",
+                board.name, response.payload[0], response.payload[1], response.payload[2]
+            );
+            Ok(())
+        }
+        Request::ReadTrace => {
+            let count = (response.payload[0] as usize).min(trace::RECORDS_PER_RESPONSE);
+            let records = &response.payload[2..2 + count * trace::RECORD_SIZE];
+            if let Some(trace) = trace {
+                trace.record(board.id, &board.name, response.payload[1], records)?;
+            }
+
+            // A full response means more records are waiting.
+            if count == trace::RECORDS_PER_RESPONSE {
+                board.send_request(Request::ReadTrace, &[])?;
+            }
+            Ok(())
+        }
+    }
+}
+
+fn update_layer(
+    layer_id: u8,
+    layer_state: u32,
+    board: &mut Board,
+    socket_server: &SocketServer,
+    state_writer: &mut StateWriter,
+) -> Result<()> {
+    // Keep the shared snapshot exact even when only lower layers changed.
+    state_writer.publish(layer_id, layer_state, protocol::monotonic_ns());
+
+    if Some(layer_id) == board.last_layer_id {
         return Ok(());
     }
 
     let status = LayerStatus {
-        layer_name: layer_name(layer_id).to_string(),
+        layer_name: layer_name(board, layer_id),
         layer_id,
         layer_state,
         timestamp: std::time::SystemTime::now()
@@ -150,94 +366,322 @@ fn handle_layer_status(
     };
 
     debug!(
-        "Layer: {} ({}), State: 0x{:04x}",
-        status.layer_name, layer_id, layer_state
+        "{}: Layer: {} ({}), State: 0x{:04x}",
+        board.name,
+        status.layer_name.unwrap_or("-"),
+        layer_id,
+        layer_state
     );
 
-    let message = SocketMessage::LayerStatus(status);
-    let json = serde_json::to_string(&message)?;
-    socket_server.broadcast(&json);
+    socket_server.broadcast(board, &SocketMessage::LayerStatus(status))?;
 
-    *last_layer_id = Some(layer_id);
+    board.last_layer_id = Some(layer_id);
     Ok(())
 }
 
-fn handle_favorite_track(socket_server: &SocketServer) -> Result<()> {
-    info!("Received favorite track command");
+fn handle_favorite_track(board: &Board, socket_server: &SocketServer) -> Result<()> {
+    info!("{}: Received favorite track command", board.name);
     let timestamp = std::time::SystemTime::now()
         .duration_since(std::time::UNIX_EPOCH)?
         .as_secs();
 
-    let message = SocketMessage::FavoriteTrack { timestamp };
-    let json = serde_json::to_string(&message)?;
-    socket_server.broadcast(&json);
-
-    Ok(())
+    socket_server.broadcast(board, &SocketMessage::FavoriteTrack { timestamp })
 }
 
-fn handle_window_hints(socket_server: &SocketServer) -> Result<()> {
-    info!("Received window hints command");
+fn handle_window_hints(board: &Board, socket_server: &SocketServer) -> Result<()> {
+    info!("{}: Received window hints command", board.name);
     let timestamp = std::time::SystemTime::now()
         .duration_since(std::time::UNIX_EPOCH)?
         .as_secs();
 
-    let message = SocketMessage::WindowHints { timestamp };
-    let json = serde_json::to_string(&message)?;
-    socket_server.broadcast(&json);
+    socket_server.broadcast(board, &SocketMessage::WindowHints { timestamp })
+}
 
+// Per-hook timing summary from firmware built with HOOK_TIMING_ENABLE. See
+// hook_timing_report_user in users/seruman/hid_protocol.c for the layout.
+fn handle_hook_timing(buffer: &[u8], board: &Board) -> Result<()> {
+    const HOOKS: [&str; 4] = ["process_record", "layer_state_set", "oled", "encoder"];
+
+    let u16_at = |i: usize| u16::from_le_bytes([buffer[i], buffer[i + 1]]);
+    let hook = HOOKS.get(buffer[1] as usize).copied().unwrap_or("?");
+    let calls = u32::from_le_bytes([buffer[2], buffer[3], buffer[4], buffer[5]]);
+    let histogram: Vec<u16> = (0..8).map(|i| u16_at(12 + 2 * i)).collect();
+
+    info!(
+        "{}: {}: {} calls, min {} avg {} max {} us, histogram {:?}, {} scans/s",
+        board.name,
+        hook,
+        calls,
+        u16_at(6),
+        u16_at(8),
+        u16_at(10),
+        histogram,
+        u16_at(28)
+    );
+    Ok(())
+}
+
+struct Packet {
+    device: DeviceId,
+    data: [u8; PACKET_SIZE],
+    received: Instant,
+}
+
+enum Event {
+    Packet(Packet),
+    Disconnected(DeviceId),
+    Hotplug,
+    TracePoll,
+}
+
+fn dispatch_packet(
+    buffer: &[u8; PACKET_SIZE],
+    board: &mut Board,
+    socket_server: &SocketServer,
+    state_writer: &mut StateWriter,
+    trace: &mut Option<KeyTrace>,
+) -> Result<()> {
+    match buffer[0] {
+        cmd if cmd == HidCommand::LayerStatus as u8 => {
+            handle_layer_status(buffer, board, socket_server, state_writer)
+        }
+        cmd if cmd == HidCommand::FavoriteTrack as u8 => {
+            handle_favorite_track(board, socket_server)
+        }
+        cmd if cmd == HidCommand::WindowHints as u8 => handle_window_hints(board, socket_server),
+        cmd if cmd == HidCommand::StateReport as u8 => {
+            handle_state_report(buffer, board, socket_server, state_writer)
+        }
+        cmd if cmd == HidCommand::Response as u8 => {
+            handle_response(buffer, board, socket_server, state_writer, trace)
+        }
+        cmd if cmd == HidCommand::HookTiming as u8 => handle_hook_timing(buffer, board),
+        _ => {
+            debug!("{}: Unknown HID command: 0x{:02x}", board.name, buffer[0]);
+            Ok(())
+        }
+    }
+}
+
+// Blocks on the hidraw fd and forwards every report as soon as it arrives.
+// Reports the disconnect once the device goes away.
+fn read_packets(device_id: DeviceId, device: HidDevice, events: mpsc::Sender<Event>) {
+    let mut data = [0u8; PACKET_SIZE];
+
+    loop {
+        match device.read(&mut data) {
+            Ok(PACKET_SIZE) => {
+                let packet = Packet {
+                    device: device_id,
+                    data,
+                    received: Instant::now(),
+                };
+                if events.send(Event::Packet(packet)).is_err() {
+                    return;
+                }
+            }
+            Ok(0) => {}
+            Ok(n) => warn!("Received partial packet: {} bytes", n),
+            Err(e) => {
+                debug!("Read error: {}", e);
+                let _ = events.send(Event::Disconnected(device_id));
+                return;
+            }
+        }
+    }
+}
+
+// Forwards hotplug events to the monitor. Returns false when hotplug
+// detection is unavailable and the monitor has to rescan periodically.
+fn watch_hotplug(events: mpsc::Sender<Event>) -> bool {
+    let hotplug = match Hotplug::new() {
+        Ok(hotplug) => hotplug,
+        Err(e) => {
+            warn!(
+                "Hotplug detection unavailable, rescanning every {:?}: {}",
+                RECONNECT_INTERVAL, e
+            );
+            return false;
+        }
+    };
+
+    let spawned = thread::Builder::new()
+        .name("hotplug".into())
+        .spawn(move || loop {
+            if let Err(e) = hotplug.wait() {
+                error!("Hotplug detection stopped: {}", e);
+                return;
+            }
+            if events.send(Event::Hotplug).is_err() {
+                return;
+            }
+        });
+
+    match spawned {
+        Ok(_) => true,
+        Err(e) => {
+            warn!("Failed to spawn hotplug thread: {}", e);
+            false
+        }
+    }
+}
+
+// Asks the monitor to drain key trace records every TRACE_POLL_INTERVAL.
+fn poll_traces(events: mpsc::Sender<Event>) -> Result<()> {
+    thread::Builder::new()
+        .name("trace-poll".into())
+        .spawn(move || loop {
+            thread::sleep(TRACE_POLL_INTERVAL);
+            if events.send(Event::TracePoll).is_err() {
+                return;
+            }
+        })
+        .context("Failed to spawn trace poll thread")?;
     Ok(())
 }
 
 struct QmkMonitor {
-    device: Option<HidDevice>,
-    last_reconnect: Instant,
     socket_server: SocketServer,
-    last_layer_id: Option<u8>,
+    state_writer: StateWriter,
+    boards: Vec<Board>,
+    latency: Arc<LatencyHistogram>,
+    trace: Option<KeyTrace>,
 }
 
 impl QmkMonitor {
-    fn new() -> Result<Self> {
-        let socket_server = SocketServer::new()?;
+    fn new(
+        socket_server: SocketServer,
+        latency: Arc<LatencyHistogram>,
+        trace: Option<KeyTrace>,
+    ) -> Result<Self> {
         socket_server.start()?;
 
+        let state_writer = StateWriter::create().context("Failed to create shared layer state")?;
+
         Ok(Self {
-            device: None,
-            last_reconnect: Instant::now(),
             socket_server,
-            last_layer_id: None,
+            state_writer,
+            boards: Vec::new(),
+            latency,
+            trace,
         })
     }
 
-    fn connect(&mut self) -> Result<()> {
-        let api = HidApi::new().context("Failed to initialize HID API")?;
+    // Returns the board previously seen with the same identity, or registers
+    // a new one.
+    fn board_for(&mut self, info: &DeviceInfo) -> Result<&mut Board> {
+        let serial = info.serial_number().map(str::to_owned);
+        let known = self.boards.iter().position(|b| {
+            b.path.is_none()
+                && b.vendor_id == info.vendor_id()
+                && b.product_id == info.product_id()
+                && b.serial == serial
+        });
 
-        let device_info = api
-            .device_list()
-            .find(|d| {
-                d.vendor_id() == VENDOR_ID
-                    && d.product_id() == PRODUCT_ID
-                    && d.usage_page() == USAGE_PAGE
-                    && d.usage() == USAGE
-            })
-            .context(format!(
-                "Keyball44 RAW HID interface not found (VID: 0x{:04x}, PID: 0x{:04x})",
-                VENDOR_ID, PRODUCT_ID
-            ))?;
-
-        let device = device_info
-            .open_device(&api)
-            .context("Failed to open HID device")?;
-
-        device
-            .set_blocking_mode(false)
-            .context("Failed to set non-blocking mode")?;
-
-        info!("Connected to Keyball44!");
-        self.device = Some(device);
-        Ok(())
+        let index = match known {
+            Some(index) => index,
+            None => {
+                let id = DeviceId::try_from(self.boards.len())
+                    .map_err(|_| anyhow::anyhow!("Too many devices"))?;
+                self.boards.push(Board {
+                    id,
+                    name: device_name(info),
+                    vendor_id: info.vendor_id(),
+                    product_id: info.product_id(),
+                    serial,
+                    layer_names: layer_names(info.vendor_id(), info.product_id()),
+                    path: None,
+                    last_layer_id: None,
+                    writer: None,
+                    requests: Requests::default(),
+                    tracing: false,
+                });
+                self.boards.len() - 1
+            }
+        };
+
+        Ok(&mut self.boards[index])
     }
 
+    // Opens every QMK raw HID interface that is not already being read and
+    // returns how many were opened.
+    fn scan(&mut self, events: &mpsc::Sender<Event>) -> usize {
+        let api = match HidApi::new() {
+            Ok(api) => api,
+            Err(e) => {
+                error!("Failed to initialize HID API: {}", e);
+                return 0;
+            }
+        };
+
+        let tracing = self.trace.is_some();
+        let mut opened = 0;
+        for info in api
+            .device_list()
+            .filter(|d| d.usage_page() == USAGE_PAGE && d.usage() == USAGE)
+        {
+            if self
+                .boards
+                .iter()
+                .any(|b| b.path.as_deref() == Some(info.path()))
+            {
+                continue;
+            }
 
+            let board = match self.board_for(info) {
+                Ok(board) => board,
+                Err(e) => {
+                    warn!("Ignoring device: {}", e);
+                    continue;
+                }
+            };
+
+            let device = match info.open_device(&api) {
+                Ok(device) => device,
+                Err(e) => {
+                    debug!("Failed to open {}: {}", board.name, e);
+                    continue;
+                }
+            };
+            if let Err(e) = device.set_blocking_mode(true) {
+                warn!("Failed to set blocking mode on {}: {}", board.name, e);
+                continue;
+            }
+            board.writer = match info.open_device(&api) {
+                Ok(writer) => Some(writer),
+                Err(e) => {
+                    warn!("{}: Cannot send requests: {}", board.name, e);
+                    None
+                }
+            };
+
+            // Sync right away rather than waiting for the next layer change.
+            // Firmware without request support just never answers.
+            board.requests.reset();
+            if let Err(e) = board.send_request(Request::GetState, &[]) {
+                debug!("{}: {}", board.name, e);
+            }
+
+            board.tracing = tracing;
+
+            let id = board.id;
+            let tx = events.clone();
+            let spawned = thread::Builder::new()
+                .name(format!("hid-reader-{}", id))
+                .spawn(move || read_packets(id, device, tx));
+            if let Err(e) = spawned {
+                error!("Failed to spawn HID reader for {}: {}", board.name, e);
+                continue;
+            }
+
+            info!("Connected to {} (device {})", board.name, id);
+            board.path = Some(info.path().to_owned());
+            board.last_layer_id = None;
+            opened += 1;
+        }
+
+        opened
+    }
 
     fn run(&mut self) -> Result<()> {
         info!("Starting QMK layer monitor...");
@@ -246,72 +690,188 @@ impl QmkMonitor {
             HidCommand::LayerStatus as u8
         );
 
-        let mut buffer = [0u8; PACKET_SIZE];
+        let (tx, rx) = mpsc::channel();
+        let hotplug = watch_hotplug(tx.clone());
+        let mut settle_until: Option<Instant> = None;
+
+        if self.trace.is_some() {
+            poll_traces(tx.clone())?;
+        }
+
+        self.scan(&tx);
+        if self.boards.is_empty() {
+            info!("Waiting for a QMK raw HID device...");
+        }
 
         loop {
-            if self.device.is_none() {
-                if self.last_reconnect.elapsed() > Duration::from_secs(3) {
-                    match self.connect() {
-                        Ok(()) => {
-                            info!("Connected successfully!");
-                        }
-                        Err(e) => {
-                            warn!("Connection failed: {}", e);
-                            self.last_reconnect = Instant::now();
+            let settling = settle_until.is_some_and(|until| Instant::now() < until);
+            let timeout = if !hotplug {
+                Some(RECONNECT_INTERVAL)
+            } else if settling {
+                Some(HOTPLUG_RETRY_INTERVAL)
+            } else {
+                None
+            };
+
+            let event = match timeout {
+                Some(timeout) => match rx.recv_timeout(timeout) {
+                    Ok(event) => event,
+                    Err(mpsc::RecvTimeoutError::Timeout) => {
+                        if self.scan(&tx) > 0 {
+                            settle_until = None;
                         }
+                        continue;
                     }
-                } else {
-                    std::thread::sleep(Duration::from_millis(100));
-                    continue;
+                    Err(mpsc::RecvTimeoutError::Disconnected) => {
+                        unreachable!("monitor holds a sender")
+                    }
+                },
+                None => rx.recv().expect("monitor holds a sender"),
+            };
+
+            match event {
+                Event::Packet(packet) => {
+                    let board = &mut self.boards[packet.device as usize];
+                    if let Err(e) = dispatch_packet(
+                        &packet.data,
+                        board,
+                        &self.socket_server,
+                        &mut self.state_writer,
+                        &mut self.trace,
+                    ) {
+                        error!("Error processing packet: {}", e);
+                    }
+                    self.latency.record(packet.received.elapsed());
                 }
-            }
-
-            if let Some(ref mut device) = self.device {
-                match device.read_timeout(&mut buffer, 100) {
-                    Ok(PACKET_SIZE) => {
-                        if buffer.is_empty() {
+                Event::Disconnected(id) => {
+                    let board = &mut self.boards[id as usize];
+                    board.path = None;
+                    board.writer = None;
+                    warn!("{} (device {}) disconnected", board.name, id);
+                    // It may come back with its clock reset.
+                    if let Some(trace) = &mut self.trace {
+                        trace.reset(id);
+                    }
+                }
+                Event::Hotplug => {
+                    settle_until = if self.scan(&tx) > 0 {
+                        None
+                    } else {
+                        // udev may not have published or chmod-ed the node yet.
+                        Some(Instant::now() + HOTPLUG_SETTLE_TIME)
+                    };
+                }
+                Event::TracePoll => {
+                    for board in self.boards.iter_mut().filter(|b| b.tracing) {
+                        if board.requests.is_pending(Request::ReadTrace) {
                             continue;
                         }
-
-                        let result = match buffer[0] {
-                            cmd if cmd == HidCommand::LayerStatus as u8 => {
-                                handle_layer_status(&buffer, &self.socket_server, &mut self.last_layer_id)
-                            }
-                            cmd if cmd == HidCommand::FavoriteTrack as u8 => {
-                                handle_favorite_track(&self.socket_server)
-                            }
-                            cmd if cmd == HidCommand::WindowHints as u8 => {
-                                handle_window_hints(&self.socket_server)
-                            }
-                            _ => {
-                                debug!("Unknown HID command: 0x{:02x}", buffer[0]);
-                                Ok(())
-                            }
-                        };
-
-                        if let Err(e) = result {
-                            error!("Error processing packet: {}", e);
+                        if let Err(e) = board.send_request(Request::ReadTrace, &[]) {
+                            debug!("{}: {}", board.name, e);
                         }
                     }
-                    Ok(0) => {}
-                    Ok(n) => warn!("Received partial packet: {} bytes", n),
-                    Err(e) => {
-                        error!("Read error: {}", e);
-                        self.device = None;
-                        self.last_reconnect = Instant::now();
-                    }
                 }
             }
+        }
+    }
+}
 
-            std::thread::sleep(Duration::from_millis(10));
+/// Blocks SIGUSR1 for the calling thread and every thread spawned after it.
+///
+/// Must run before any other thread is spawned so that the signal is only
+/// ever consumed by `dump_on_sigusr1`.
+fn block_sigusr1() -> Result<libc::sigset_t> {
+    let mut set: libc::sigset_t = unsafe { std::mem::zeroed() };
+    unsafe {
+        libc::sigemptyset(&mut set);
+        libc::sigaddset(&mut set, libc::SIGUSR1);
+        if libc::pthread_sigmask(libc::SIG_BLOCK, &set, std::ptr::null_mut()) != 0 {
+            bail!("Failed to block SIGUSR1");
         }
     }
+    Ok(set)
+}
+
+/// Runs `dump` every time the process receives SIGUSR1.
+fn dump_on_sigusr1(set: libc::sigset_t, dump: impl Fn() + Send + 'static) {
+    thread::spawn(move || loop {
+        let mut signal = 0;
+        if unsafe { libc::sigwait(&set, &mut signal) } == 0 && signal == libc::SIGUSR1 {
+            dump();
+        }
+    });
+}
+
+const HELP: &str = "Usage: qmk-layer-monitor [--trace <file.json>]
+       qmk-layer-monitor --get-pointer | --set-layer <n> | --save | --read-queue";
+
+enum Mode {
+    // Key trace output file, if any.
+    Monitor(Option<PathBuf>),
+    Command(Command),
+}
+
+fn parse_args() -> Result<Mode> {
+    let mut args = std::env::args().skip(1);
+    let mut trace = None;
+    let mut command = None;
+
+    while let Some(arg) = args.next() {
+        let (request, arg) = match arg.as_str() {
+            "--trace" => {
+                trace = Some(args.next().context(HELP)?.into());
+                continue;
+            }
+            "--get-pointer" => (Request::GetPointer, None),
+            "--set-layer" => {
+                let layer = args.next().context(HELP)?;
+                let layer = layer
+                    .parse()
+                    .with_context(|| format!("Invalid layer: {}", layer))?;
+                (Request::SetLayer, Some(layer))
+            }
+            "--save" => (Request::Save, None),
+            "--read-queue" => (Request::ReadQueue, None),
+            _ => bail!("Unknown argument: {}\n{}", arg, HELP),
+        };
+        if command.is_some() {
+            bail!("Only one request at a time\n{}", HELP);
+        }
+        command = Some(Command { request, arg });
+    }
+
+    match command {
+        Some(_) if trace.is_some() => bail!("--trace only applies to monitoring\n{}", HELP),
+        Some(command) => Ok(Mode::Command(command)),
+        None => Ok(Mode::Monitor(trace)),
+    }
 }
 
 fn main() -> Result<()> {
     env_logger::Builder::from_env(env_logger::Env::default().default_filter_or("info")).init();
 
-    let mut monitor = QmkMonitor::new()?;
+    let trace = match parse_args()? {
+        Mode::Command(command) => return command::run(command),
+        Mode::Monitor(Some(path)) => {
+            info!("Writing key traces to {}", path.display());
+            Some(KeyTrace::create(&path)?)
+        }
+        Mode::Monitor(None) => None,
+    };
+
+    let sigusr1 = block_sigusr1()?;
+
+    let latency = Arc::new(LatencyHistogram::new());
+    let socket_server = SocketServer::new()?;
+
+    let latency_stats = Arc::clone(&latency);
+    let broadcast_stats = Arc::clone(&socket_server.broadcaster);
+    dump_on_sigusr1(sigusr1, move || {
+        latency_stats.dump();
+        broadcast_stats.dump_stats();
+    });
+
+    let mut monitor = QmkMonitor::new(socket_server, latency, trace)?;
 
     ctrlc::set_handler(move || {
         info!("Received Ctrl+C, exiting...");
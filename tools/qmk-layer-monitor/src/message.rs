@@ -0,0 +1,55 @@
+use anyhow::Result;
+use serde::Serialize;
+
+use crate::protocol::{BinaryRecord, Protocol};
+
+#[derive(Debug, Clone, Serialize)]
+pub struct LayerStatus {
+    /// Only for boards listed in LAYER_NAMES.
+    #[serde(rename = "name", skip_serializing_if = "Option::is_none")]
+    pub layer_name: Option<&'static str>,
+    #[serde(rename = "id")]
+    pub layer_id: u8,
+    #[serde(rename = "state")]
+    pub layer_state: u32,
+    pub timestamp: u64,
+}
+
+#[derive(Debug, Clone, Serialize)]
+#[serde(tag = "action", content = "data")]
+pub enum SocketMessage {
+    #[serde(rename = "layer_status")]
+    LayerStatus(LayerStatus),
+    #[serde(rename = "favorite_track")]
+    FavoriteTrack { timestamp: u64 },
+    #[serde(rename = "window_hints")]
+    WindowHints { timestamp: u64 },
+}
+
+/// A SocketMessage as sent to JSON clients, tagged with the board it came
+/// from.
+#[derive(Serialize)]
+pub struct TaggedMessage<'a> {
+    pub device_id: u8,
+    pub device: &'a str,
+    #[serde(flatten)]
+    pub message: &'a SocketMessage,
+}
+
+/// Writes `tagged` into `frame` as one newline-terminated JSON line, or
+/// `record` for binary clients. This is what every client is sent.
+pub fn encode(
+    protocol: Protocol,
+    tagged: &TaggedMessage,
+    record: &BinaryRecord,
+    frame: &mut Vec<u8>,
+) -> Result<()> {
+    match protocol {
+        Protocol::Json => {
+            serde_json::to_writer(&mut *frame, tagged)?;
+            frame.push(b'\n');
+        }
+        Protocol::Binary => frame.extend_from_slice(&record.to_le_bytes()),
+    }
+    Ok(())
+}
@@ -0,0 +1,79 @@
+use std::time::Duration;
+
+/// Sent by a client right after connecting to receive `BinaryRecord`s
+/// instead of newline-delimited JSON: ASCII "QMKB" followed by the protocol
+/// version as a little-endian u32.
+pub const BINARY_HELLO: [u8; 8] = *b"QMKB\x01\x00\x00\x00";
+
+/// How long a new client gets to send BINARY_HELLO, in total, before it is
+/// treated as a JSON client.
+pub const HELLO_TIMEOUT: Duration = Duration::from_millis(50);
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Protocol {
+    Json,
+    Binary,
+}
+
+/// Classifies the bytes a client sent so far: None while they are still a
+/// prefix of BINARY_HELLO, JSON as soon as they stray from it.
+pub fn sniff(hello: &[u8]) -> Option<Protocol> {
+    if hello == BINARY_HELLO {
+        Some(Protocol::Binary)
+    } else if BINARY_HELLO.starts_with(hello) {
+        None
+    } else {
+        Some(Protocol::Json)
+    }
+}
+
+pub const BINARY_RECORD_SIZE: usize = 32;
+
+/// Fixed-size little-endian event record, the same size as the raw HID
+/// report and with the same first two bytes.
+///
+/// ```text
+/// offset  size  field
+///      0     1  command (HidCommand)
+///      1     1  layer id (0 unless command is LayerStatus)
+///      2     1  device id, stable per board while the monitor runs
+///      3     1  reserved, zero
+///      4     4  layer state bitmask
+///      8     8  CLOCK_MONOTONIC timestamp in ns
+///     16     8  sequence number, increments by one per event
+///     24     8  reserved, zero
+/// ```
+///
+/// A gap in the sequence numbers means the client was too slow and frames
+/// were dropped.
+#[derive(Debug, Clone, Copy)]
+pub struct BinaryRecord {
+    pub command: u8,
+    pub layer_id: u8,
+    pub device_id: u8,
+    pub layer_state: u32,
+    pub timestamp_ns: u64,
+    pub sequence: u64,
+}
+
+impl BinaryRecord {
+    pub fn to_le_bytes(&self) -> [u8; BINARY_RECORD_SIZE] {
+        let mut record = [0u8; BINARY_RECORD_SIZE];
+        record[0] = self.command;
+        record[1] = self.layer_id;
+        record[2] = self.device_id;
+        record[4..8].copy_from_slice(&self.layer_state.to_le_bytes());
+        record[8..16].copy_from_slice(&self.timestamp_ns.to_le_bytes());
+        record[16..24].copy_from_slice(&self.sequence.to_le_bytes());
+        record
+    }
+}
+
+pub fn monotonic_ns() -> u64 {
+    let mut ts = libc::timespec {
+        tv_sec: 0,
+        tv_nsec: 0,
+    };
+    unsafe { libc::clock_gettime(libc::CLOCK_MONOTONIC, &mut ts) };
+    ts.tv_sec as u64 * 1_000_000_000 + ts.tv_nsec as u64
+}
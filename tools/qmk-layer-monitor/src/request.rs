@@ -0,0 +1,108 @@
+use anyhow::{Context, Result};
+use hidapi::HidDevice;
+use std::collections::VecDeque;
+
+use crate::PACKET_SIZE;
+
+// Responses are answered in order, so only a handful can usefully be in
+// flight; anything older than this is assumed lost.
+const MAX_IN_FLIGHT: usize = 8;
+
+/// Host to keyboard requests; see users/seruman/hid_protocol.h.
+#[repr(u8)]
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub enum Request {
+    GetState = 0x41,
+    GetPointer = 0x42,
+    SetLayer = 0x43,
+    Save = 0x44,
+    ReadTrace = 0x45,
+    ReadQueue = 0x46,
+}
+
+#[repr(u8)]
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub enum Status {
+    Ok = 0x00,
+    UnknownRequest = 0x01,
+    InvalidArgument = 0x02,
+}
+
+impl Status {
+    fn from_u8(status: u8) -> Option<Self> {
+        match status {
+            0x00 => Some(Status::Ok),
+            0x01 => Some(Status::UnknownRequest),
+            0x02 => Some(Status::InvalidArgument),
+            _ => None,
+        }
+    }
+}
+
+/// A response report: [0] Response, [1] request, [2] sequence number,
+/// [3] status, [4..] payload.
+pub struct Response<'a> {
+    pub request: Request,
+    pub status: Option<Status>,
+    pub payload: &'a [u8],
+}
+
+/// Sequence numbers and in-flight requests for one board.
+#[derive(Default)]
+pub struct Requests {
+    next_seq: u8,
+    in_flight: VecDeque<(u8, Request)>,
+}
+
+impl Requests {
+    /// Sends `request` without waiting for its response, so several can be
+    /// pipelined in one round trip.
+    pub fn send(&mut self, device: &HidDevice, request: Request, args: &[u8]) -> Result<()> {
+        let seq = self.next_seq;
+        self.next_seq = self.next_seq.wrapping_add(1);
+
+        // hidapi expects the report id first; QMK's raw HID has none.
+        let mut report = [0u8; PACKET_SIZE + 1];
+        report[1] = request as u8;
+        report[2] = seq;
+        report[3..3 + args.len()].copy_from_slice(args);
+
+        device
+            .write(&report)
+            .with_context(|| format!("Failed to send {:?}", request))?;
+
+        if self.in_flight.len() == MAX_IN_FLIGHT {
+            self.in_flight.pop_front();
+        }
+        self.in_flight.push_back((seq, request));
+        Ok(())
+    }
+
+    /// Matches a response report against the oldest in-flight request with
+    /// the same sequence number, forgetting older ones that were never
+    /// answered.
+    pub fn complete<'a>(&mut self, buffer: &'a [u8]) -> Option<Response<'a>> {
+        let seq = buffer[2];
+        let index = self.in_flight.iter().position(|(s, _)| *s == seq)?;
+        let (_, request) = self.in_flight.drain(..=index).last()?;
+
+        if buffer[1] != request as u8 {
+            return None;
+        }
+
+        Some(Response {
+            request,
+            status: Status::from_u8(buffer[3]),
+            payload: &buffer[4..],
+        })
+    }
+
+    pub fn is_pending(&self, request: Request) -> bool {
+        self.in_flight.iter().any(|(_, r)| *r == request)
+    }
+
+    /// Forgets everything in flight, e.g. after a reconnect.
+    pub fn reset(&mut self) {
+        self.in_flight.clear();
+    }
+}
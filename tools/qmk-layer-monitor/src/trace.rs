@@ -0,0 +1,176 @@
+use anyhow::{Context, Result};
+use serde_json::{json, Value};
+use std::collections::{HashMap, HashSet};
+use std::fs::File;
+use std::io::{BufWriter, Write};
+use std::path::Path;
+
+use crate::{DeviceId, PACKET_SIZE};
+
+/// Size of one key_trace record; see key_trace.h in users/seruman.
+pub const RECORD_SIZE: usize = 8;
+
+/// Records per ReadTrace response, after the response header and the
+/// record and dropped counts.
+pub const RECORDS_PER_RESPONSE: usize = (PACKET_SIZE - 6) / RECORD_SIZE;
+
+const STAGE_MATRIX: u8 = 0;
+const STAGE_RESOLVED: u8 = 1;
+const STAGE_SENT: u8 = 2;
+const PRESSED: u8 = 0x80;
+
+const DECISION_TAP: u8 = 1;
+const DECISION_HOLD: u8 = 2;
+
+// Extends the firmware's wrapping 32-bit microsecond clock.
+#[derive(Default)]
+struct Clock {
+    last: u32,
+    high: u64,
+}
+
+impl Clock {
+    fn extend(&mut self, time_us: u32) -> u64 {
+        if time_us < self.last {
+            self.high += 1 << 32;
+        }
+        self.last = time_us;
+        self.high + time_us as u64
+    }
+}
+
+/// Writes key trace records as Chrome trace events, viewable in Perfetto or
+/// chrome://tracing.
+///
+/// Every board is a process and every key a thread. Each stage a key event
+/// passes is an instant event. The time between stages is a span: tap-hold
+/// resolution from the matrix to process_record, then processing up to the
+/// HID report.
+///
+/// Events are appended as they arrive without ever closing the JSON array,
+/// which both viewers accept, so the file stays usable however the monitor
+/// exits.
+pub struct KeyTrace {
+    out: BufWriter<File>,
+    clocks: HashMap<DeviceId, Clock>,
+    // Stage and time each key was last seen at, per direction.
+    last: HashMap<(DeviceId, u8, u8, bool), (u8, u64)>,
+    named: HashSet<(DeviceId, Option<(u8, u8)>)>,
+}
+
+impl KeyTrace {
+    pub fn create(path: &Path) -> Result<Self> {
+        let file = File::create(path)
+            .with_context(|| format!("Failed to create trace file {}", path.display()))?;
+        let mut out = BufWriter::new(file);
+        out.write_all(b"[\n")?;
+
+        Ok(Self {
+            out,
+            clocks: HashMap::new(),
+            last: HashMap::new(),
+            named: HashSet::new(),
+        })
+    }
+
+    /// Forgets a board's clock and pending stages, e.g. after it reset.
+    pub fn reset(&mut self, device_id: DeviceId) {
+        self.clocks.remove(&device_id);
+        self.last.retain(|key, _| key.0 != device_id);
+    }
+
+    /// Appends the records from one ReadTrace response.
+    pub fn record(
+        &mut self,
+        device_id: DeviceId,
+        device: &str,
+        mut dropped: u8,
+        records: &[u8],
+    ) -> Result<()> {
+        if self.named.insert((device_id, None)) {
+            self.write(json!({
+                "ph": "M", "name": "process_name", "pid": device_id,
+                "args": { "name": device },
+            }))?;
+        }
+
+        for record in records.chunks_exact(RECORD_SIZE) {
+            let time_us = u32::from_le_bytes([record[0], record[1], record[2], record[3]]);
+            let ts = self.clocks.entry(device_id).or_default().extend(time_us);
+
+            if dropped > 0 {
+                self.write(json!({
+                    "ph": "i", "s": "p", "name": format!("{} records dropped", dropped),
+                    "pid": device_id, "ts": ts,
+                }))?;
+                dropped = 0;
+            }
+
+            self.key_event(device_id, ts, record[4], record[5], record[6], record[7])?;
+        }
+
+        self.out.flush()?;
+        Ok(())
+    }
+
+    fn key_event(
+        &mut self,
+        device_id: DeviceId,
+        ts: u64,
+        row: u8,
+        col: u8,
+        event: u8,
+        decision: u8,
+    ) -> Result<()> {
+        let stage = event & !PRESSED;
+        let pressed = event & PRESSED != 0;
+        let tid = (row as u32) << 8 | col as u32;
+
+        if self.named.insert((device_id, Some((row, col)))) {
+            self.write(json!({
+                "ph": "M", "name": "thread_name", "pid": device_id, "tid": tid,
+                "args": { "name": format!("row {} col {}", row, col) },
+            }))?;
+        }
+
+        let direction = if pressed { "press" } else { "release" };
+        let previous = self
+            .last
+            .insert((device_id, row, col, pressed), (stage, ts));
+
+        if let Some((previous_stage, start)) = previous {
+            let span = match (previous_stage, stage) {
+                (STAGE_MATRIX, STAGE_RESOLVED) => Some(match decision {
+                    DECISION_TAP => "tap-hold: tap",
+                    DECISION_HOLD => "tap-hold: hold",
+                    _ => "resolve",
+                }),
+                (STAGE_RESOLVED, STAGE_SENT) => Some("process"),
+                _ => None,
+            };
+            if let Some(span) = span {
+                self.write(json!({
+                    "ph": "X", "name": format!("{} {}", span, direction),
+                    "pid": device_id, "tid": tid, "ts": start, "dur": ts.saturating_sub(start),
+                }))?;
+            }
+        }
+
+        let name = match stage {
+            STAGE_MATRIX => "matrix",
+            STAGE_RESOLVED => "resolved",
+            STAGE_SENT => "sent",
+            _ => "unknown",
+        };
+        self.write(json!({
+            "ph": "i", "s": "t", "name": format!("{} {}", name, direction),
+            "pid": device_id, "tid": tid, "ts": ts,
+        }))
+    }
+
+    fn write(&mut self, event: Value) -> Result<()> {
+        serde_json::to_writer(&mut self.out, &event)?;
+        self.out.write_all(b",\n")?;
+        Ok(())
+    }
+}
@@ -0,0 +1,69 @@
+// Latest keyboard layer state published by qmk-layer-monitor.
+//
+// Map it once, then call qmk_layer_state_read() as often as needed; reads
+// are lock-free and do not enter the kernel:
+//
+//     int fd = shm_open(QMK_LAYER_STATE_SHM_NAME, O_RDONLY, 0);
+//     const struct qmk_layer_state *shm =
+//         mmap(NULL, sizeof(*shm), PROT_READ, MAP_SHARED, fd, 0);
+//     close(fd);
+//
+//     struct qmk_layer_snapshot snap;
+//     if (qmk_layer_state_valid(shm)) {
+//         qmk_layer_state_read(shm, &snap);
+//     }
+//
+// Keep in sync with src/lib.rs.
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define QMK_LAYER_STATE_SHM_NAME "/qmk-layer-state"
+#define QMK_LAYER_STATE_MAGIC 0x534B4D51u // "QMKS" little-endian
+#define QMK_LAYER_STATE_VERSION 1u
+
+struct qmk_layer_state {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t seq; // odd while an update is in progress
+    uint8_t  layer_id;
+    uint8_t  reserved0[3];
+    uint32_t layer_state;
+    uint32_t reserved1;
+    uint64_t timestamp_ns; // CLOCK_MONOTONIC of the last layer event
+    uint64_t event_count;
+};
+
+_Static_assert(sizeof(struct qmk_layer_state) == 40, "qmk_layer_state layout changed");
+
+struct qmk_layer_snapshot {
+    uint8_t  layer_id;    // highest active layer
+    uint32_t layer_state; // bitmask of active layers
+    uint64_t timestamp_ns;
+    uint64_t event_count;
+};
+
+static inline bool qmk_layer_state_valid(const struct qmk_layer_state *shm) {
+    return __atomic_load_n(&shm->magic, __ATOMIC_ACQUIRE) == QMK_LAYER_STATE_MAGIC && __atomic_load_n(&shm->version, __ATOMIC_RELAXED) == QMK_LAYER_STATE_VERSION;
+}
+
+static inline void qmk_layer_state_read(const struct qmk_layer_state *shm, struct qmk_layer_snapshot *out) {
+    for (;;) {
+        uint32_t seq = __atomic_load_n(&shm->seq, __ATOMIC_ACQUIRE);
+        if (seq & 1) {
+            continue;
+        }
+
+        out->layer_id     = __atomic_load_n(&shm->layer_id, __ATOMIC_RELAXED);
+        out->layer_state  = __atomic_load_n(&shm->layer_state, __ATOMIC_RELAXED);
+        out->timestamp_ns = __atomic_load_n(&shm->timestamp_ns, __ATOMIC_RELAXED);
+        out->event_count  = __atomic_load_n(&shm->event_count, __ATOMIC_RELAXED);
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&shm->seq, __ATOMIC_RELAXED) == seq) {
+            return;
+        }
+    }
+}
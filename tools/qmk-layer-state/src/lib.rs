@@ -0,0 +1,184 @@
+//! Latest keyboard layer state, published by qmk-layer-monitor in a POSIX
+//! shared memory object and guarded by a seqlock.
+//!
+//! Readers map the object once and then read it without any syscalls or
+//! locks. A read only retries if it raced with an update. The layout is
+//! mirrored in `include/qmk_layer_state.h` for C consumers.
+//!
+//! With several boards connected, the state is that of whichever board
+//! reported a layer change last.
+
+use std::ffi::CStr;
+use std::io;
+use std::mem::size_of;
+use std::ptr;
+use std::sync::atomic::{fence, AtomicU32, AtomicU64, AtomicU8, Ordering};
+
+/// Name passed to shm_open(3); the object shows up as /dev/shm/qmk-layer-state.
+pub const SHM_NAME: &CStr = c"/qmk-layer-state";
+
+pub const MAGIC: u32 = u32::from_le_bytes(*b"QMKS");
+pub const VERSION: u32 = 1;
+
+#[repr(C)]
+struct Shared {
+    magic: AtomicU32,
+    version: AtomicU32,
+    // Odd while an update is in progress.
+    seq: AtomicU32,
+    layer_id: AtomicU8,
+    _reserved0: [u8; 3],
+    layer_state: AtomicU32,
+    _reserved1: u32,
+    timestamp_ns: AtomicU64,
+    event_count: AtomicU64,
+}
+
+const _: () = assert!(size_of::<Shared>() == 40);
+
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct LayerState {
+    /// Highest active layer.
+    pub layer_id: u8,
+    /// Bitmask of active layers.
+    pub layer_state: u32,
+    /// CLOCK_MONOTONIC time of the last layer event, in ns.
+    pub timestamp_ns: u64,
+    /// Number of layer events published since the shared object was created.
+    pub event_count: u64,
+}
+
+fn map(oflag: libc::c_int, prot: libc::c_int) -> io::Result<*mut Shared> {
+    let len = size_of::<Shared>();
+
+    unsafe {
+        let fd = libc::shm_open(SHM_NAME.as_ptr(), oflag | libc::O_CLOEXEC, 0o644);
+        if fd < 0 {
+            return Err(io::Error::last_os_error());
+        }
+
+        if oflag & libc::O_CREAT != 0 && libc::ftruncate(fd, len as libc::off_t) < 0 {
+            let err = io::Error::last_os_error();
+            libc::close(fd);
+            return Err(err);
+        }
+
+        let addr = libc::mmap(ptr::null_mut(), len, prot, libc::MAP_SHARED, fd, 0);
+        libc::close(fd);
+        if addr == libc::MAP_FAILED {
+            return Err(io::Error::last_os_error());
+        }
+
+        Ok(addr as *mut Shared)
+    }
+}
+
+fn unmap(shared: *const Shared) {
+    unsafe { libc::munmap(shared as *mut libc::c_void, size_of::<Shared>()) };
+}
+
+/// Single writer side, owned by qmk-layer-monitor.
+pub struct StateWriter {
+    shared: *mut Shared,
+}
+
+// Only ever touched through atomics; there is exactly one writer.
+unsafe impl Send for StateWriter {}
+
+impl StateWriter {
+    /// Creates the shared object, or reuses the one left behind by a previous
+    /// monitor so that readers which already mapped it keep working.
+    pub fn create() -> io::Result<Self> {
+        let shared = map(libc::O_CREAT | libc::O_RDWR, libc::PROT_READ | libc::PROT_WRITE)?;
+
+        let shm = unsafe { &*shared };
+        // A previous writer may have died mid-update.
+        let seq = shm.seq.load(Ordering::Relaxed);
+        if seq & 1 != 0 {
+            shm.seq.store(seq.wrapping_add(1), Ordering::Release);
+        }
+        shm.version.store(VERSION, Ordering::Relaxed);
+        shm.magic.store(MAGIC, Ordering::Release);
+
+        Ok(Self { shared })
+    }
+
+    pub fn publish(&mut self, layer_id: u8, layer_state: u32, timestamp_ns: u64) {
+        let shm = unsafe { &*self.shared };
+
+        let seq = shm.seq.load(Ordering::Relaxed);
+        shm.seq.store(seq.wrapping_add(1), Ordering::Relaxed);
+        fence(Ordering::Release);
+
+        shm.layer_id.store(layer_id, Ordering::Relaxed);
+        shm.layer_state.store(layer_state, Ordering::Relaxed);
+        shm.timestamp_ns.store(timestamp_ns, Ordering::Relaxed);
+        shm.event_count.fetch_add(1, Ordering::Relaxed);
+
+        shm.seq.store(seq.wrapping_add(2), Ordering::Release);
+    }
+}
+
+impl Drop for StateWriter {
+    fn drop(&mut self) {
+        unmap(self.shared);
+    }
+}
+
+pub struct StateReader {
+    shared: *const Shared,
+}
+
+unsafe impl Send for StateReader {}
+unsafe impl Sync for StateReader {}
+
+impl StateReader {
+    /// Maps the state published by a running qmk-layer-monitor.
+    pub fn open() -> io::Result<Self> {
+        let shared = map(libc::O_RDONLY, libc::PROT_READ)?;
+
+        let shm = unsafe { &*shared };
+        if shm.magic.load(Ordering::Acquire) != MAGIC
+            || shm.version.load(Ordering::Relaxed) != VERSION
+        {
+            unmap(shared);
+            return Err(io::Error::new(
+                io::ErrorKind::InvalidData,
+                "unexpected qmk-layer-state magic or version",
+            ));
+        }
+
+        Ok(Self { shared })
+    }
+
+    /// Returns a consistent copy of the latest state.
+    pub fn read(&self) -> LayerState {
+        let shm = unsafe { &*self.shared };
+
+        loop {
+            let seq = shm.seq.load(Ordering::Acquire);
+            if seq & 1 != 0 {
+                std::hint::spin_loop();
+                continue;
+            }
+
+            let state = LayerState {
+                layer_id: shm.layer_id.load(Ordering::Relaxed),
+                layer_state: shm.layer_state.load(Ordering::Relaxed),
+                timestamp_ns: shm.timestamp_ns.load(Ordering::Relaxed),
+                event_count: shm.event_count.load(Ordering::Relaxed),
+            };
+
+            fence(Ordering::Acquire);
+            if shm.seq.load(Ordering::Relaxed) == seq {
+                return state;
+            }
+        }
+    }
+}
+
+impl Drop for StateReader {
+    fn drop(&mut self) {
+        unmap(self.shared);
+    }
+}
@@ -0,0 +1,166 @@
+#include QMK_KEYBOARD_H
+
+#include "adaptive_term.h"
+
+#define ADAPTIVE_TERM_VERSION 1
+
+// Hold durations from 0 to 256 ms; the last bucket also takes anything
+// longer.
+#define BUCKETS 16
+#define BUCKET_MS 16
+
+typedef struct __attribute__((packed)) {
+    uint16_t keycode; // 0 for a free slot.
+    uint16_t term;    // 0 until learned.
+} slot_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t version;
+    uint8_t slot_count;
+    slot_t  slots[ADAPTIVE_TERM_SLOTS];
+} saved_terms_t;
+
+_Static_assert(sizeof(saved_terms_t) <= EECONFIG_USER_DATA_SIZE, "EECONFIG_USER_DATA_SIZE too small for the learned terms");
+
+typedef struct {
+    uint8_t  histogram[BUCKETS];
+    uint16_t samples;
+    uint16_t pressed_at;
+    bool     in_streak;
+    bool     interrupted;
+    bool     down;
+} key_stats_t;
+
+static saved_terms_t saved;
+static key_stats_t   stats[ADAPTIVE_TERM_SLOTS];
+static uint16_t      last_press;
+static bool          dirty;
+static uint32_t      last_save;
+
+void adaptive_term_init(void) {
+    eeconfig_read_user_datablock(&saved, 0, sizeof(saved));
+
+    if (saved.version != ADAPTIVE_TERM_VERSION || saved.slot_count != ADAPTIVE_TERM_SLOTS) {
+        memset(&saved, 0, sizeof(saved));
+        saved.version    = ADAPTIVE_TERM_VERSION;
+        saved.slot_count = ADAPTIVE_TERM_SLOTS;
+    }
+    last_save = timer_read32();
+}
+
+static int8_t slot_for(uint16_t keycode) {
+    int8_t free = -1;
+
+    for (int8_t i = 0; i < ADAPTIVE_TERM_SLOTS; i++) {
+        if (saved.slots[i].keycode == keycode) {
+            return i;
+        }
+        if (free < 0 && saved.slots[i].keycode == 0) {
+            free = i;
+        }
+    }
+    if (free >= 0) {
+        saved.slots[free].keycode = keycode;
+        saved.slots[free].term    = 0;
+    }
+    return free;
+}
+
+static void learn(int8_t slot, uint16_t held) {
+    key_stats_t *s      = &stats[slot];
+    uint8_t      bucket = MIN(held / BUCKET_MS, BUCKETS - 1);
+
+    // Halve everything rather than saturate, so recent samples weigh more.
+    if (s->histogram[bucket] == UINT8_MAX) {
+        s->samples = 0;
+        for (uint8_t i = 0; i < BUCKETS; i++) {
+            s->histogram[i] >>= 1;
+            s->samples += s->histogram[i];
+        }
+    }
+    s->histogram[bucket]++;
+    s->samples++;
+
+    if (s->samples < ADAPTIVE_TERM_MIN_SAMPLES) {
+        return;
+    }
+
+    uint16_t below = 0;
+    uint8_t  p95   = 0;
+    while (p95 < BUCKETS - 1 && (uint32_t)(below + s->histogram[p95]) * 20 < (uint32_t)s->samples * 19) {
+        below += s->histogram[p95];
+        p95++;
+    }
+
+    uint16_t term = (p95 + 1) * BUCKET_MS + ADAPTIVE_TERM_MARGIN;
+    if (term != saved.slots[slot].term) {
+        saved.slots[slot].term = term;
+        dirty                  = true;
+    }
+}
+
+void adaptive_term_record(uint16_t keycode, keyrecord_t *record) {
+    uint16_t now = record->event.time;
+
+    if (!IS_QK_MOD_TAP(keycode)) {
+        if (record->event.pressed) {
+            for (uint8_t i = 0; i < ADAPTIVE_TERM_SLOTS; i++) {
+                stats[i].interrupted = true;
+            }
+            last_press = now;
+        }
+        return;
+    }
+
+    int8_t slot = slot_for(keycode);
+    if (slot < 0) {
+        return;
+    }
+    key_stats_t *s = &stats[slot];
+
+    if (record->event.pressed) {
+        for (uint8_t i = 0; i < ADAPTIVE_TERM_SLOTS; i++) {
+            stats[i].interrupted = true;
+        }
+        s->in_streak   = TIMER_DIFF_16(now, last_press) < ADAPTIVE_TERM_STREAK_MS;
+        s->interrupted = false;
+        s->pressed_at  = now;
+        s->down        = true;
+        last_press     = now;
+        return;
+    }
+
+    if (!s->down) {
+        return;
+    }
+    s->down = false;
+
+    uint16_t held = TIMER_DIFF_16(now, s->pressed_at);
+    if (record->tap.count > 0) {
+        if (s->in_streak) {
+            learn(slot, held);
+        }
+    } else if (!s->interrupted && held < GET_TAPPING_TERM(keycode, record) + ADAPTIVE_TERM_RANGE) {
+        // A modifier held much longer on its own was probably meant, e.g.
+        // for a modified mouse click.
+        learn(slot, held);
+    }
+}
+
+uint16_t adaptive_term_get(uint16_t keycode, uint16_t term) {
+    for (uint8_t i = 0; i < ADAPTIVE_TERM_SLOTS; i++) {
+        if (saved.slots[i].keycode == keycode && saved.slots[i].term != 0) {
+            uint16_t lowest = term > ADAPTIVE_TERM_RANGE ? term - ADAPTIVE_TERM_RANGE : 0;
+            return MIN(MAX(saved.slots[i].term, lowest), term + ADAPTIVE_TERM_RANGE);
+        }
+    }
+    return term;
+}
+
+void adaptive_term_task(void) {
+    if (dirty && timer_elapsed32(last_save) >= ADAPTIVE_TERM_SAVE_INTERVAL) {
+        eeconfig_update_user_datablock(&saved, 0, sizeof(saved));
+        dirty     = false;
+        last_save = timer_read32();
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "action.h"
+
+// Opt-in per-key tapping terms learned while typing, enabled with
+// ADAPTIVE_TERM_ENABLE = yes in a keymap's rules.mk (the keymap also needs
+// TAPPING_TERM_PER_KEY).
+//
+// Each mod-tap key gets a slot, up to ADAPTIVE_TERM_SLOTS, holding a small
+// histogram of how long it was held when it was meant as a tap:
+//   - taps typed within ADAPTIVE_TERM_STREAK_MS of the previous key press,
+//     i.e. mid-word, where a long term delays output the most, and
+//   - holds released without any other key pressed meanwhile, which send
+//     nothing but a modifier and were most likely slow taps.
+// Once a slot has enough samples, its term becomes the 95th percentile plus
+// a margin, clamped to within ADAPTIVE_TERM_RANGE of the keymap's own term.
+// Old samples decay, so the terms follow changes in typing.
+//
+// Learned terms survive reboots in the EEPROM user datablock. They are
+// written at most once per ADAPTIVE_TERM_SAVE_INTERVAL, and only when one
+// of them changed.
+
+#ifndef ADAPTIVE_TERM_STREAK_MS
+#    define ADAPTIVE_TERM_STREAK_MS 200
+#endif
+
+#ifndef ADAPTIVE_TERM_RANGE
+#    define ADAPTIVE_TERM_RANGE 50
+#endif
+
+#ifndef ADAPTIVE_TERM_MARGIN
+#    define ADAPTIVE_TERM_MARGIN 15
+#endif
+
+#ifndef ADAPTIVE_TERM_MIN_SAMPLES
+#    define ADAPTIVE_TERM_MIN_SAMPLES 32
+#endif
+
+#ifndef ADAPTIVE_TERM_SAVE_INTERVAL
+#    define ADAPTIVE_TERM_SAVE_INTERVAL 600000
+#endif
+
+#ifdef ADAPTIVE_TERM_ENABLE
+
+// Call from keyboard_post_init_user, process_record_user (for every key)
+// and housekeeping_task_user respectively.
+void adaptive_term_init(void);
+void adaptive_term_record(uint16_t keycode, keyrecord_t *record);
+void adaptive_term_task(void);
+
+// Returns the learned term for `keycode`, or `term` while there is none.
+uint16_t adaptive_term_get(uint16_t keycode, uint16_t term);
+
+#else
+
+#    define adaptive_term_init()
+#    define adaptive_term_record(keycode, record)
+#    define adaptive_term_task()
+#    define adaptive_term_get(keycode, term) (term)
+
+#endif
@@ -0,0 +1,44 @@
+#include QMK_KEYBOARD_H
+
+#include "chordal_hold.h"
+
+__attribute__((weak)) const uint16_t PROGMEM chordal_hold_always[] = {KC_NO};
+
+// Base layer positions of the chordal_hold_always keys, one bit per column.
+static matrix_row_t always_hold[MATRIX_ROWS];
+
+void chordal_hold_init(void) {
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        always_hold[row] = 0;
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            const uint16_t keycode = keymap_key_to_keycode(0, (keypos_t){.row = row, .col = col});
+            for (const uint16_t *always = chordal_hold_always; pgm_read_word(always) != KC_NO; always++) {
+                if (pgm_read_word(always) == keycode) {
+                    always_hold[row] |= (matrix_row_t)1 << col;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+char chordal_hold_handedness(keypos_t key) {
+    // Combos and other keys outside the matrix chord with either hand.
+    if (key.row >= MATRIX_ROWS || key.col >= MATRIX_COLS) {
+        return '*';
+    }
+#ifdef SPLIT_KEYBOARD
+    return key.row < MATRIX_ROWS / 2 ? 'L' : 'R';
+#else
+    return key.col < MATRIX_COLS / 2 ? 'L' : 'R';
+#endif
+}
+
+bool get_chordal_hold(uint16_t tap_hold_keycode, keyrecord_t *tap_hold_record, uint16_t other_keycode, keyrecord_t *other_record) {
+    const keypos_t key = tap_hold_record->event.key;
+    if (key.row < MATRIX_ROWS && (always_hold[key.row] & ((matrix_row_t)1 << key.col))) {
+        return true;
+    }
+
+    return get_chordal_hold_default(tap_hold_record, other_record);
+}
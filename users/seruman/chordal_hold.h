@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stdint.h>
+
+// Chordal hold shared by the keymaps, enabled with CHORDAL_HOLD_ENABLE = yes
+// in a keymap's rules.mk instead of defining CHORDAL_HOLD in its config.h.
+//
+// A tap-hold key chorded with a key on the same hand settles as a tap, and
+// as a hold with one on the other hand. The hand of a key follows from the
+// split matrix, where the right half's rows come after the left's, so no
+// per-board layout table is needed.
+//
+// Keymaps may list tap-hold keys that hold in any chord, terminated by
+// KC_NO:
+//
+//     const uint16_t PROGMEM chordal_hold_always[] = {LCTL_T(KC_TAB), KC_NO};
+//
+// Their positions on the base layer are collected into a bitmap once at
+// startup, so a chord decision never compares keycodes.
+
+#ifdef CHORDAL_HOLD
+
+extern const uint16_t chordal_hold_always[];
+
+// Call from keyboard_post_init_user.
+void chordal_hold_init(void);
+
+#else
+
+#    define chordal_hold_init()
+
+#endif
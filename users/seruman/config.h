@@ -0,0 +1,11 @@
+#pragma once
+
+#ifdef ADAPTIVE_TERM_ENABLE
+#    ifndef ADAPTIVE_TERM_SLOTS
+#        define ADAPTIVE_TERM_SLOTS 8
+#    endif
+// Learned terms: version and slot count, then keycode and term per slot.
+#    define EECONFIG_USER_DATA_SIZE (2 + 4 * ADAPTIVE_TERM_SLOTS)
+// Learned terms are applied through get_tapping_term.
+#    define TAPPING_TERM_PER_KEY
+#endif
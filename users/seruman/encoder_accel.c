@@ -0,0 +1,130 @@
+#include QMK_KEYBOARD_H
+
+#include "encoder_accel.h"
+#include "hook_timing.h"
+#include "output_queue.h"
+
+// Fixed point with 8 fractional bits.
+#define Q8(x) ((int32_t)((x) * 256))
+
+typedef struct {
+    // Steps not sent yet in Q8, positive clockwise.
+    int16_t  pending;
+    uint32_t last_detent;
+    // Pressed on the previous pass and released on this one.
+    uint16_t held;
+} encoder_state_t;
+
+static encoder_state_t encoders[NUM_ENCODERS];
+
+static int16_t detent_gain(uint32_t interval) {
+    if (interval >= ENCODER_ACCEL_SLOW_MS) {
+        return Q8(1);
+    }
+    return Q8(1) + Q8(ENCODER_ACCEL_MAX_GAIN - 1) * (ENCODER_ACCEL_SLOW_MS - interval) / ENCODER_ACCEL_SLOW_MS;
+}
+
+bool encoder_update_user(uint8_t index, bool clockwise) {
+    HOOK_TIMING_SCOPE(HOOK_ENCODER);
+
+    if (index >= NUM_ENCODERS) {
+        return false;
+    }
+
+    encoder_state_t *encoder = &encoders[index];
+    int16_t          step    = detent_gain(timer_elapsed32(encoder->last_detent));
+    encoder->last_detent     = timer_read32();
+
+    if (!clockwise) {
+        step = -step;
+    }
+    if ((encoder->pending ^ step) < 0) {
+        encoder->pending = 0;
+    }
+    encoder->pending = MAX(-Q8(ENCODER_ACCEL_MAX_PENDING), MIN(Q8(ENCODER_ACCEL_MAX_PENDING), encoder->pending + step));
+    return false;
+}
+
+#ifdef POINTING_DEVICE_ENABLE
+
+static void send_wheel(encoder_state_t *encoder) {
+#    ifdef POINTING_DEVICE_HIRES_SCROLL_ENABLE
+    // Wheel units per detent, set at build time rather than by the host, so
+    // a host ignoring the multiplier scrolls that many times too far.
+    uint16_t resolution = pointing_device_get_hires_scroll_resolution();
+#    else
+    uint16_t resolution = 1;
+#    endif
+
+    int32_t units = (int32_t)encoder->pending * resolution / Q8(1);
+    if (units == 0) {
+        return;
+    }
+
+    // Clockwise scrolls down. Whatever does not fit in this report goes out
+    // with the next one.
+    report_mouse_t report = pointing_device_get_report();
+    int32_t        v      = MAX(HV_REPORT_MIN, MIN(HV_REPORT_MAX, report.v - units));
+    encoder->pending -= (report.v - v) * Q8(1) / resolution;
+    report.v = v;
+    pointing_device_set_report(report);
+}
+
+#else
+
+// Takes one whole step off `pending` and returns its keycode, or KC_NO.
+static uint16_t take_step(uint8_t index, encoder_state_t *encoder) {
+    if (encoder->pending >= Q8(1)) {
+        encoder->pending -= Q8(1);
+        return pgm_read_word(&encoder_accel_map[index][1]);
+    }
+    if (encoder->pending <= -Q8(1)) {
+        encoder->pending += Q8(1);
+        return pgm_read_word(&encoder_accel_map[index][0]);
+    }
+    return KC_NO;
+}
+
+#    ifdef OUTPUT_QUEUE_ENABLE
+
+// Only tops up an empty queue, so steps wait here, capped, rather than pile
+// up behind other output.
+static void send_key(uint8_t index, encoder_state_t *encoder) {
+    if (output_queue_depth() > 0) {
+        return;
+    }
+
+    uint16_t keycode = take_step(index, encoder);
+    if (keycode != KC_NO) {
+        output_queue_tap(keycode);
+    }
+}
+
+#    else
+
+static void send_key(uint8_t index, encoder_state_t *encoder) {
+    if (encoder->held != KC_NO) {
+        unregister_code16(encoder->held);
+        encoder->held = KC_NO;
+        return;
+    }
+
+    encoder->held = take_step(index, encoder);
+    if (encoder->held != KC_NO) {
+        register_code16(encoder->held);
+    }
+}
+
+#    endif
+
+#endif
+
+void encoder_accel_task(void) {
+    for (uint8_t i = 0; i < NUM_ENCODERS; i++) {
+#ifdef POINTING_DEVICE_ENABLE
+        send_wheel(&encoders[i]);
+#else
+        send_key(i, &encoders[i]);
+#endif
+    }
+}
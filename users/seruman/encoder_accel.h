@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stdint.h>
+
+// Coalesced, velocity-scaled encoder output, enabled with
+// ENCODER_ACCEL_ENABLE = yes in a keymap's rules.mk. The library then owns
+// encoder_update_user and the keymap provides encoder_accel_map.
+//
+// encoder_update_user only records detents. Each detent is weighted by how
+// soon it followed the previous one on the same encoder: 1 step at
+// ENCODER_ACCEL_SLOW_MS apart or slower, rising linearly to
+// ENCODER_ACCEL_MAX_GAIN steps for back to back detents. Reversing
+// direction drops whatever had not been sent yet.
+//
+// encoder_accel_task turns the recorded steps into output:
+//   - with a pointing device, all of them go out at once as wheel motion,
+//     in hi-res units with POINTING_DEVICE_HIRES_SCROLL_ENABLE, which only
+//     scrolls at the right speed on hosts that apply the HID Resolution
+//     Multiplier;
+//   - otherwise as the encoder's keycode, one tap at a time through the
+//     output queue when OUTPUT_QUEUE_ENABLE is set, or else pressed on one
+//     pass and released on the next, so no pass blocks on a tap. At most
+//     ENCODER_ACCEL_MAX_PENDING steps wait, so output stops soon after the
+//     encoder does.
+
+#ifndef ENCODER_ACCEL_SLOW_MS
+#    define ENCODER_ACCEL_SLOW_MS 80
+#endif
+
+#ifndef ENCODER_ACCEL_MAX_GAIN
+#    define ENCODER_ACCEL_MAX_GAIN 4
+#endif
+
+#ifndef ENCODER_ACCEL_MAX_PENDING
+#    define ENCODER_ACCEL_MAX_PENDING 16
+#endif
+
+#ifdef ENCODER_ACCEL_ENABLE
+
+// Keycodes sent per encoder without a pointing device, counter-clockwise
+// first, like ENCODER_CCW_CW.
+extern const uint16_t PROGMEM encoder_accel_map[NUM_ENCODERS][2];
+
+// Call from housekeeping_task_user.
+void encoder_accel_task(void);
+
+#else
+
+#    define encoder_accel_task()
+
+#endif
@@ -0,0 +1,91 @@
+#include QMK_KEYBOARD_H
+
+#include "raw_hid.h"
+
+#include "hid_protocol.h"
+#include "hook_timing.h"
+#include "key_trace.h"
+#include "output_queue.h"
+
+// Key trace records that fit in one response after the two count bytes.
+#define TRACE_RECORDS_PER_RESPONSE ((HID_RESPONSE_PAYLOAD_SIZE - 2) / KEY_TRACE_RECORD_SIZE)
+
+void hid_send_command(hid_command_t cmd, uint8_t arg) {
+    uint8_t data[HID_REPORT_SIZE];
+    memset(data, 0, HID_REPORT_SIZE);
+    data[0] = cmd;
+    data[1] = arg;
+    raw_hid_send(data, HID_REPORT_SIZE);
+}
+
+void hid_put_u16(uint8_t *buf, uint16_t value) {
+    buf[0] = (uint8_t)(value & 0xFF);
+    buf[1] = (uint8_t)(value >> 8);
+}
+
+void hid_put_u32(uint8_t *buf, uint32_t value) {
+    hid_put_u16(buf, (uint16_t)(value & 0xFFFF));
+    hid_put_u16(buf + 2, (uint16_t)(value >> 16));
+}
+
+__attribute__((weak)) hid_status_t hid_request_keymap(const uint8_t *request, uint8_t *payload) {
+    return HID_STATUS_UNKNOWN_REQUEST;
+}
+
+static hid_status_t handle_hid_request(const uint8_t *request, uint8_t *payload) {
+    switch (request[0]) {
+#ifdef KEY_TRACE_ENABLE
+        case HID_REQ_READ_TRACE:
+            payload[0] = key_trace_drain(&payload[2], TRACE_RECORDS_PER_RESPONSE, &payload[1]);
+            return HID_STATUS_OK;
+#endif
+#ifdef OUTPUT_QUEUE_ENABLE
+        case HID_REQ_READ_QUEUE:
+            payload[0] = output_queue_depth();
+            output_queue_read_stats(&payload[1], &payload[2]);
+            return HID_STATUS_OK;
+#endif
+    }
+    return hid_request_keymap(request, payload);
+}
+
+// Answered inline, so pipelined requests are answered in the order they
+// arrive.
+void raw_hid_receive(uint8_t *data, uint8_t length) {
+    uint8_t response[HID_REPORT_SIZE];
+
+    if (length < 2) {
+        return;
+    }
+
+    memset(response, 0, HID_REPORT_SIZE);
+    response[0] = HID_CMD_RESPONSE;
+    response[1] = data[0];
+    response[2] = data[1];
+    response[3] = handle_hid_request(data, &response[4]);
+    raw_hid_send(response, HID_REPORT_SIZE);
+}
+
+#ifdef HOOK_TIMING_ENABLE
+
+// Hook timing report, once per hook and window:
+//   [0] HID_CMD_HOOK_TIMING  [1] hook            [2..5] calls      [6..7] min us
+//   [8..9] avg us            [10..11] max us     [12..27] histogram, 8 x u16
+//   [28..29] scans per second
+void hook_timing_report_user(hook_id_t hook, const hook_stats_t *stats, uint16_t scan_rate) {
+    uint8_t data[HID_REPORT_SIZE];
+
+    memset(data, 0, HID_REPORT_SIZE);
+    data[0] = HID_CMD_HOOK_TIMING;
+    data[1] = hook;
+    hid_put_u32(&data[2], stats->count);
+    hid_put_u16(&data[6], stats->min_us);
+    hid_put_u16(&data[8], MIN(stats->total_us / stats->count, UINT16_MAX));
+    hid_put_u16(&data[10], stats->max_us);
+    for (uint8_t i = 0; i < HOOK_TIMING_BUCKETS; i++) {
+        hid_put_u16(&data[12 + 2 * i], stats->histogram[i]);
+    }
+    hid_put_u16(&data[28], scan_rate);
+    raw_hid_send(data, HID_REPORT_SIZE);
+}
+#endif
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stdint.h>
+
+// Raw HID protocol spoken with tools/qmk-layer-monitor, built when a
+// keymap's rules.mk has RAW_ENABLE = yes. Every report is
+// HID_REPORT_SIZE bytes, multi-byte fields are little-endian.
+
+#define HID_REPORT_SIZE 32
+
+// Unsolicited reports: [0] command, [1..] payload.
+typedef enum {
+    HID_CMD_LAYER_STATUS   = 0x01,
+    HID_CMD_FAVORITE_TRACK = 0x02,
+    HID_CMD_WINDOW_HINTS   = 0x03,
+    HID_CMD_STATE_REPORT   = 0x04,
+    HID_CMD_RESPONSE       = 0x05,
+    HID_CMD_HOOK_TIMING    = 0x06,
+} hid_command_t;
+
+// Requests from the host: [0] request, [1] sequence number, [2..] arguments.
+// Each one is answered, in order, with
+// [0] HID_CMD_RESPONSE, [1] request, [2] sequence number, [3] status, [4..] payload.
+typedef enum {
+    HID_REQ_GET_STATE   = 0x41, // -> state payload, as in the state report
+    HID_REQ_GET_POINTER = 0x42, // -> [4] CPI / 100, [5] scroll divider, [6] scroll mode
+    HID_REQ_SET_LAYER   = 0x43, // [2] layer -> state payload
+    HID_REQ_SAVE        = 0x44, // KBC_SAVE
+    HID_REQ_READ_TRACE  = 0x45, // -> [4] records, [5] dropped, [6..] key_trace records
+    HID_REQ_READ_QUEUE  = 0x46, // -> [4] depth, [5] max depth, [6] dropped presses, since the last read
+} hid_request_t;
+
+typedef enum {
+    HID_STATUS_OK              = 0x00,
+    HID_STATUS_UNKNOWN_REQUEST = 0x01,
+    HID_STATUS_INVALID_ARG     = 0x02,
+} hid_status_t;
+
+// Bytes left for the payload of a response.
+#define HID_RESPONSE_PAYLOAD_SIZE (HID_REPORT_SIZE - 4)
+
+#ifdef RAW_ENABLE
+
+// Sends a report made of `cmd` and `arg`, zero padded.
+void hid_send_command(hid_command_t cmd, uint8_t arg);
+
+void hid_put_u16(uint8_t *buf, uint16_t value);
+void hid_put_u32(uint8_t *buf, uint32_t value);
+
+// Weak, answers HID_STATUS_UNKNOWN_REQUEST by default. Called for every
+// request the library does not handle itself, with the response payload
+// zeroed.
+hid_status_t hid_request_keymap(const uint8_t *request, uint8_t *payload);
+
+#endif
@@ -0,0 +1,82 @@
+#include QMK_KEYBOARD_H
+
+#include "hook_timing.h"
+#include "timer_us.h"
+
+static hook_stats_t stats[HOOK_COUNT];
+static uint32_t     window_start;
+static uint32_t     window_scans;
+
+hook_timing_scope_t hook_timing_begin(hook_id_t hook) {
+    return (hook_timing_scope_t){.hook = hook, .start = timer_read_us()};
+}
+
+void hook_timing_end(hook_timing_scope_t *scope) {
+    uint32_t      us     = timer_read_us() - scope->start;
+    hook_stats_t *s      = &stats[scope->hook];
+    uint16_t      us16   = MIN(us, UINT16_MAX);
+    uint8_t       bucket = 0;
+
+    if (s->count == 0 || us16 < s->min_us) {
+        s->min_us = us16;
+    }
+    if (us16 > s->max_us) {
+        s->max_us = us16;
+    }
+    s->count++;
+    s->total_us += us;
+
+    while (us >= 2 && bucket < HOOK_TIMING_BUCKETS - 1) {
+        us >>= 2;
+        bucket++;
+    }
+    if (s->histogram[bucket] < UINT16_MAX) {
+        s->histogram[bucket]++;
+    }
+}
+
+const char *hook_timing_name(hook_id_t hook) {
+    switch (hook) {
+        case HOOK_PROCESS_RECORD:
+            return "process_record";
+        case HOOK_LAYER_STATE_SET:
+            return "layer_state_set";
+        case HOOK_OLED:
+            return "oled";
+        case HOOK_ENCODER:
+            return "encoder";
+        default:
+            return "?";
+    }
+}
+
+__attribute__((weak)) void hook_timing_report_user(hook_id_t hook, const hook_stats_t *stats, uint16_t scan_rate) {}
+
+void hook_timing_task(void) {
+    window_scans++;
+
+    uint32_t elapsed = timer_elapsed32(window_start);
+    if (elapsed < HOOK_TIMING_REPORT_MS) {
+        return;
+    }
+
+    uint16_t scan_rate = MIN(window_scans * 1000 / elapsed, UINT16_MAX);
+
+#ifdef CONSOLE_ENABLE
+    uprintf("hook timing: %u scans/s\n", scan_rate);
+#endif
+    for (uint8_t hook = 0; hook < HOOK_COUNT; hook++) {
+        const hook_stats_t *s = &stats[hook];
+        if (s->count == 0) {
+            continue;
+        }
+#ifdef CONSOLE_ENABLE
+        uprintf("  %s: %lu calls, min %u avg %lu max %u us\n", hook_timing_name(hook), s->count, s->min_us, s->total_us / s->count, s->max_us);
+#endif
+        hook_timing_report_user(hook, s, scan_rate);
+    }
+
+    memset(stats, 0, sizeof(stats));
+    window_start = timer_read32();
+    window_scans = 0;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stdint.h>
+
+// Opt-in timing of the user hooks, enabled with HOOK_TIMING_ENABLE = yes in
+// a keymap's rules.mk. Every hook invocation is timed in microseconds and
+// folded into per-hook stats that are reported and reset once per window.
+//
+// Put HOOK_TIMING_SCOPE(hook) at the top of a hook; the measurement ends at
+// whichever return leaves it. Without HOOK_TIMING_ENABLE it expands to
+// nothing.
+//
+// The stats go to the console only with CONSOLE_ENABLE, which none of the
+// boards set. keyball44 sends them over raw HID instead, where
+// qmk-layer-monitor logs them; on the other boards nothing reads them.
+
+typedef enum {
+    HOOK_PROCESS_RECORD,
+    HOOK_LAYER_STATE_SET,
+    HOOK_OLED,
+    HOOK_ENCODER,
+    HOOK_COUNT,
+} hook_id_t;
+
+// Bucket 0 holds calls under 2 us, bucket i < 7 those in [2^(2i-1), 2^(2i+1))
+// us, bucket 7 everything from 8192 us on.
+#define HOOK_TIMING_BUCKETS 8
+
+#ifndef HOOK_TIMING_REPORT_MS
+#    define HOOK_TIMING_REPORT_MS 5000
+#endif
+
+typedef struct {
+    uint32_t count;
+    uint32_t total_us;
+    uint16_t min_us;
+    uint16_t max_us;
+    uint16_t histogram[HOOK_TIMING_BUCKETS];
+} hook_stats_t;
+
+#ifdef HOOK_TIMING_ENABLE
+
+typedef struct {
+    hook_id_t hook;
+    uint32_t  start;
+} hook_timing_scope_t;
+
+hook_timing_scope_t hook_timing_begin(hook_id_t hook);
+void                hook_timing_end(hook_timing_scope_t *scope);
+
+#    define HOOK_TIMING_SCOPE(hook) hook_timing_scope_t hook_timing_scope __attribute__((cleanup(hook_timing_end), unused)) = hook_timing_begin(hook)
+
+// Call from housekeeping_task_user. At the end of each window, prints the
+// stats to the console when it is enabled, hands them to
+// hook_timing_report_user() and starts a new window.
+void hook_timing_task(void);
+
+// Weak, does nothing by default. `scan_rate` is the number of housekeeping
+// passes, i.e. main loop iterations, per second over the window.
+void hook_timing_report_user(hook_id_t hook, const hook_stats_t *stats, uint16_t scan_rate);
+
+const char *hook_timing_name(hook_id_t hook);
+
+#else
+
+#    define HOOK_TIMING_SCOPE(hook)
+#    define hook_timing_task()
+
+#endif
@@ -0,0 +1,69 @@
+#include QMK_KEYBOARD_H
+
+#include "key_trace.h"
+#include "timer_us.h"
+
+_Static_assert(KEY_TRACE_SIZE <= 128 && (KEY_TRACE_SIZE & (KEY_TRACE_SIZE - 1)) == 0, "KEY_TRACE_SIZE must be a power of two up to 128");
+
+typedef struct {
+    uint32_t time_us;
+    uint8_t  row;
+    uint8_t  col;
+    uint8_t  event;
+    uint8_t  decision;
+} trace_record_t;
+
+static trace_record_t records[KEY_TRACE_SIZE];
+static uint8_t        head;
+static uint8_t        tail;
+static uint8_t        dropped_records;
+
+static key_trace_decision_t decision_for(key_trace_stage_t stage, uint16_t keycode, keyrecord_t *record) {
+    if (stage != KEY_TRACE_RESOLVED || !(IS_QK_MOD_TAP(keycode) || IS_QK_LAYER_TAP(keycode))) {
+        return KEY_TRACE_PLAIN;
+    }
+    return record->tap.count > 0 ? KEY_TRACE_TAP : KEY_TRACE_HOLD;
+}
+
+void key_trace(key_trace_stage_t stage, uint16_t keycode, keyrecord_t *record) {
+    if ((uint8_t)(head - tail) == KEY_TRACE_SIZE) {
+        if (dropped_records < UINT8_MAX) {
+            dropped_records++;
+        }
+        return;
+    }
+
+    trace_record_t *r = &records[head % KEY_TRACE_SIZE];
+
+    r->time_us  = timer_read_us();
+    r->row      = record->event.key.row;
+    r->col      = record->event.key.col;
+    r->event    = stage | (record->event.pressed ? KEY_TRACE_PRESSED : 0);
+    r->decision = decision_for(stage, keycode, record);
+    head++;
+}
+
+uint8_t key_trace_drain(uint8_t *buf, uint8_t max_records, uint8_t *dropped) {
+    uint8_t count = 0;
+
+    while (count < max_records && tail != head) {
+        const trace_record_t *r = &records[tail % KEY_TRACE_SIZE];
+
+        buf[0] = (uint8_t)(r->time_us & 0xFF);
+        buf[1] = (uint8_t)((r->time_us >> 8) & 0xFF);
+        buf[2] = (uint8_t)((r->time_us >> 16) & 0xFF);
+        buf[3] = (uint8_t)((r->time_us >> 24) & 0xFF);
+        buf[4] = r->row;
+        buf[5] = r->col;
+        buf[6] = r->event;
+        buf[7] = r->decision;
+
+        buf += KEY_TRACE_RECORD_SIZE;
+        tail++;
+        count++;
+    }
+
+    *dropped        = dropped_records;
+    dropped_records = 0;
+    return count;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "action.h"
+
+// Opt-in keystroke tracer, enabled with KEY_TRACE_ENABLE = yes in a keymap's
+// rules.mk. Each key event is timestamped as it passes three points:
+//
+//   KEY_TRACE_MATRIX    pre_process_record_user, right after the matrix scan
+//                       (on the master, for keys of either half)
+//   KEY_TRACE_RESOLVED  process_record_user, once tap-hold has decided
+//   KEY_TRACE_SENT      post_process_record_user, after its HID reports
+//
+// Records queue up in a small ring buffer until the host drains them. When
+// the host falls behind, new records are dropped and counted.
+//
+// Record layout, 8 bytes:
+//   [0..3] timestamp in us (LE, wraps)  [4] row  [5] col
+//   [6] stage | KEY_TRACE_PRESSED       [7] key_trace_decision_t
+
+typedef enum {
+    KEY_TRACE_MATRIX,
+    KEY_TRACE_RESOLVED,
+    KEY_TRACE_SENT,
+} key_trace_stage_t;
+
+typedef enum {
+    KEY_TRACE_PLAIN, // Not a tap-hold key.
+    KEY_TRACE_TAP,
+    KEY_TRACE_HOLD,
+} key_trace_decision_t;
+
+#define KEY_TRACE_PRESSED 0x80
+#define KEY_TRACE_RECORD_SIZE 8
+
+// A power of two up to 128.
+#ifndef KEY_TRACE_SIZE
+#    define KEY_TRACE_SIZE 32
+#endif
+
+#ifdef KEY_TRACE_ENABLE
+
+void key_trace(key_trace_stage_t stage, uint16_t keycode, keyrecord_t *record);
+
+// Moves up to `max_records` of the oldest records into `buf` and returns how
+// many it moved. `dropped` receives the number of records lost since the
+// previous drain, saturating at 255.
+uint8_t key_trace_drain(uint8_t *buf, uint8_t max_records, uint8_t *dropped);
+
+#else
+
+#    define key_trace(stage, keycode, record)
+
+#endif
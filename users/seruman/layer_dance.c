@@ -0,0 +1,38 @@
+#include QMK_KEYBOARD_H
+
+#include "layer_dance.h"
+
+// Indexed by [count - 1][interrupted][pressed].
+static const uint8_t PROGMEM outcomes[DANCE_MAX_TAPS][2][2] = {
+    // An interrupted single tap is a tap even if still held; holding it
+    // needs permissive hold, which tap dances do not support.
+    {{DANCE_TAP, DANCE_HOLD}, {DANCE_TAP, DANCE_TAP}},
+    {{DANCE_DOUBLE_TAP, DANCE_DOUBLE_HOLD}, {DANCE_DOUBLE_SINGLE_TAP, DANCE_DOUBLE_SINGLE_TAP}},
+    {{DANCE_TRIPLE_TAP, DANCE_TRIPLE_HOLD}, {DANCE_TRIPLE_TAP, DANCE_TRIPLE_TAP}},
+};
+
+dance_outcome_t layer_dance_outcome(uint8_t count, bool interrupted, bool pressed) {
+    if (count == 0 || count > DANCE_MAX_TAPS) {
+        return DANCE_NONE;
+    }
+    return pgm_read_byte(&outcomes[count - 1][interrupted][pressed]);
+}
+
+void layer_dance_finished(tap_dance_state_t *state, void *user_data) {
+    layer_dance_t  *dance   = (layer_dance_t *)user_data;
+    dance_outcome_t outcome = layer_dance_outcome(state->count, state->interrupted, state->pressed);
+
+    dance->active = pgm_read_byte(&dance->layers[outcome]);
+    if (dance->active != 0) {
+        layer_on(dance->active);
+    }
+}
+
+void layer_dance_reset(tap_dance_state_t *state, void *user_data) {
+    layer_dance_t *dance = (layer_dance_t *)user_data;
+
+    if (dance->active != 0) {
+        layer_off(dance->active);
+        dance->active = 0;
+    }
+}
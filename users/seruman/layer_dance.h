@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Tap dances that turn on a layer while the dance key is held, enabled with
+// LAYER_DANCE_ENABLE = yes in a keymap's rules.mk.
+//
+// A finished dance resolves to one of the outcomes below from its tap
+// count and whether it was interrupted or is still held, through a single
+// table lookup. Each dance is a PROGMEM table from outcome to layer; the
+// layer is on from the end of the dance until it is reset:
+//
+//     static const uint8_t PROGMEM lower_layers[DANCE_OUTCOMES] = {
+//         [DANCE_TAP]         = _LOWER,
+//         [DANCE_HOLD]        = _LOWER,
+//         [DANCE_DOUBLE_HOLD] = _DOUBLE_LOWER,
+//     };
+//
+//     tap_dance_action_t tap_dance_actions[] = {
+//         [TD_LOWER] = ACTION_TAP_DANCE_LAYERS(lower_layers),
+//     };
+//
+// Outcomes left out map to layer 0, which means none; the base layer is
+// always on anyway.
+
+typedef enum {
+    DANCE_NONE,
+    DANCE_TAP,
+    DANCE_HOLD,
+    DANCE_DOUBLE_TAP,
+    DANCE_DOUBLE_HOLD,
+    // Two taps interrupted by another key, most likely typing the single
+    // tap action twice.
+    DANCE_DOUBLE_SINGLE_TAP,
+    DANCE_TRIPLE_TAP,
+    DANCE_TRIPLE_HOLD,
+    DANCE_OUTCOMES,
+} dance_outcome_t;
+
+// Taps beyond this resolve to DANCE_NONE.
+#define DANCE_MAX_TAPS 3
+
+typedef struct {
+    const uint8_t *layers;
+    // Layer turned on by the current dance, 0 while there is none.
+    uint8_t active;
+} layer_dance_t;
+
+dance_outcome_t layer_dance_outcome(uint8_t count, bool interrupted, bool pressed);
+
+#ifdef LAYER_DANCE_ENABLE
+
+void layer_dance_finished(tap_dance_state_t *state, void *user_data);
+void layer_dance_reset(tap_dance_state_t *state, void *user_data);
+
+#    define ACTION_TAP_DANCE_LAYERS(dance_layers) \
+        { .fn = {NULL, layer_dance_finished, layer_dance_reset}, .user_data = (void *)&((layer_dance_t){dance_layers, 0}), }
+
+#endif
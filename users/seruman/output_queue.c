@@ -0,0 +1,129 @@
+#include QMK_KEYBOARD_H
+
+#include "output_queue.h"
+
+typedef struct {
+    uint16_t keycode;
+    // Real modifiers, pressed or released in place of a keycode when set.
+    uint8_t mods;
+    bool    pressed;
+} output_event_t;
+
+static output_event_t events[OUTPUT_QUEUE_SIZE];
+
+// Free running; the queue holds events [tail, head).
+static uint8_t head = 0;
+static uint8_t tail = 0;
+
+// Presses queued or sent whose release is not queued yet.
+static uint8_t held = 0;
+
+static uint8_t max_depth = 0;
+static uint8_t dropped   = 0;
+
+static deferred_token sender = INVALID_DEFERRED_TOKEN;
+
+uint8_t output_queue_depth(void) {
+    return (uint8_t)(head - tail);
+}
+
+void output_queue_read_stats(uint8_t *max_depth_out, uint8_t *dropped_out) {
+    *max_depth_out = max_depth;
+    *dropped_out   = dropped;
+    max_depth      = output_queue_depth();
+    dropped        = 0;
+}
+
+static void send_event(const output_event_t *event) {
+    if (event->mods != 0) {
+        if (event->pressed) {
+            register_mods(event->mods);
+        } else {
+            unregister_mods(event->mods);
+        }
+    } else if (event->pressed) {
+        register_code16(event->keycode);
+    } else {
+        unregister_code16(event->keycode);
+    }
+}
+
+static uint32_t send_next(uint32_t trigger_time, void *cb_arg) {
+    send_event(&events[tail++ % OUTPUT_QUEUE_SIZE]);
+
+    if (head == tail) {
+        sender = INVALID_DEFERRED_TOKEN;
+        return 0;
+    }
+    return OUTPUT_QUEUE_DELAY_MS;
+}
+
+static void push(uint16_t keycode, uint8_t mods, bool pressed) {
+    events[head++ % OUTPUT_QUEUE_SIZE] = (output_event_t){keycode, mods, pressed};
+    max_depth = MAX(max_depth, output_queue_depth());
+
+    if (sender == INVALID_DEFERRED_TOKEN) {
+        sender = defer_exec(OUTPUT_QUEUE_DELAY_MS, send_next, NULL);
+    }
+    // With every executor slot taken, send it all now rather than leave a
+    // release waiting for a push that may never come.
+    if (sender == INVALID_DEFERRED_TOKEN) {
+        while (head != tail) {
+            send_event(&events[tail++ % OUTPUT_QUEUE_SIZE]);
+        }
+    }
+}
+
+// Room for `presses` more presses and their releases, on top of the
+// releases already owed.
+static bool has_room(uint8_t presses) {
+    if (output_queue_depth() + held + 2 * presses > OUTPUT_QUEUE_SIZE) {
+        if (dropped < UINT8_MAX) {
+            dropped++;
+        }
+        return false;
+    }
+    return true;
+}
+
+bool output_queue_press(uint16_t keycode) {
+    if (!has_room(1)) {
+        return false;
+    }
+    held++;
+    push(keycode, 0, true);
+    return true;
+}
+
+void output_queue_release(uint16_t keycode) {
+    // Room for this was set aside when the press was accepted.
+    if (held > 0) {
+        held--;
+    }
+    push(keycode, 0, false);
+}
+
+bool output_queue_press_chord(uint8_t mods, uint16_t keycode) {
+    if (!has_room(2)) {
+        return false;
+    }
+    held += 2;
+    push(KC_NO, mods, true);
+    push(keycode, 0, true);
+    return true;
+}
+
+void output_queue_release_chord(uint8_t mods, uint16_t keycode) {
+    held = held > 2 ? held - 2 : 0;
+    push(KC_NO, mods, false);
+    push(keycode, 0, false);
+}
+
+bool output_queue_tap(uint16_t keycode) {
+    if (!has_room(1)) {
+        return false;
+    }
+    push(keycode, 0, true);
+    push(keycode, 0, false);
+    return true;
+}
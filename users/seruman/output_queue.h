@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Key output spread over later main loop passes instead of sent inline,
+// enabled with OUTPUT_QUEUE_ENABLE = yes in a keymap's rules.mk.
+//
+// Presses and releases of 16-bit keycodes, modifiers included, go into a
+// ring of OUTPUT_QUEUE_SIZE events. A deferred executor callback sends one
+// event every OUTPUT_QUEUE_DELAY_MS, so a sequence never holds up the
+// matrix scan or tap-hold timing the way tap_code with TAP_CODE_DELAY does.
+// Should no executor slot be free, the queue is sent at once instead.
+//
+// A press is only queued while there is room for its release as well as
+// for the releases of every press still held, so a full queue never
+// leaves a key stuck.
+//
+// Without OUTPUT_QUEUE_ENABLE the calls fall back to QMK's blocking ones.
+
+#ifndef OUTPUT_QUEUE_SIZE
+#    define OUTPUT_QUEUE_SIZE 32
+#endif
+
+#ifndef OUTPUT_QUEUE_DELAY_MS
+#    define OUTPUT_QUEUE_DELAY_MS 1
+#endif
+
+#ifdef OUTPUT_QUEUE_ENABLE
+
+_Static_assert((OUTPUT_QUEUE_SIZE & (OUTPUT_QUEUE_SIZE - 1)) == 0 && OUTPUT_QUEUE_SIZE <= 128, "OUTPUT_QUEUE_SIZE must be a power of two up to 128");
+
+// Return false, and send nothing, when the queue is full.
+bool output_queue_press(uint16_t keycode);
+bool output_queue_tap(uint16_t keycode);
+// Only for presses output_queue_press accepted.
+void output_queue_release(uint16_t keycode);
+
+// `mods` as real modifiers, like register_mods, together with `keycode`:
+// pressed mods first, released mods first. Unlike a modded keycode through
+// output_queue_press, the mods are not weak, so they combine with mods the
+// user holds. The release is only for chords that were accepted.
+bool output_queue_press_chord(uint8_t mods, uint16_t keycode);
+void output_queue_release_chord(uint8_t mods, uint16_t keycode);
+
+// Events waiting to be sent.
+uint8_t output_queue_depth(void);
+
+// Deepest the queue got and presses refused for lack of room since the
+// previous call, saturating at 255.
+void output_queue_read_stats(uint8_t *max_depth, uint8_t *dropped);
+
+#else
+
+#    define output_queue_press(keycode) (register_code16(keycode), true)
+#    define output_queue_tap(keycode) (tap_code16(keycode), true)
+#    define output_queue_release(keycode) unregister_code16(keycode)
+#    define output_queue_press_chord(mods, keycode) (register_mods(mods), register_code16(keycode), true)
+#    define output_queue_release_chord(mods, keycode) (unregister_mods(mods), unregister_code16(keycode))
+#    define output_queue_depth() 0
+
+#endif
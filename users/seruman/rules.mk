@@ -0,0 +1,54 @@
+SRC += seruman.c
+
+ifeq ($(strip $(RAW_ENABLE)), yes)
+    SRC += hid_protocol.c
+endif
+
+ifeq ($(strip $(TRI_LAYER_STATE_ENABLE)), yes)
+    OPT_DEFS += -DTRI_LAYER_STATE_ENABLE
+endif
+
+ifeq ($(strip $(HOOK_TIMING_ENABLE)), yes)
+    SRC += hook_timing.c
+    OPT_DEFS += -DHOOK_TIMING_ENABLE
+    TIMER_US_REQUIRED = yes
+endif
+
+ifeq ($(strip $(KEY_TRACE_ENABLE)), yes)
+    SRC += key_trace.c
+    OPT_DEFS += -DKEY_TRACE_ENABLE
+    TIMER_US_REQUIRED = yes
+endif
+
+ifeq ($(strip $(ADAPTIVE_TERM_ENABLE)), yes)
+    SRC += adaptive_term.c
+    OPT_DEFS += -DADAPTIVE_TERM_ENABLE
+endif
+
+ifeq ($(strip $(CHORDAL_HOLD_ENABLE)), yes)
+    SRC += chordal_hold.c
+    OPT_DEFS += -DCHORDAL_HOLD
+endif
+
+ifeq ($(strip $(LAYER_DANCE_ENABLE)), yes)
+    TAP_DANCE_ENABLE = yes
+    SRC += layer_dance.c
+    OPT_DEFS += -DLAYER_DANCE_ENABLE
+endif
+
+ifeq ($(strip $(ENCODER_ACCEL_ENABLE)), yes)
+    ENCODER_ENABLE = yes
+    SRC += encoder_accel.c
+    OPT_DEFS += -DENCODER_ACCEL_ENABLE
+endif
+
+ifeq ($(strip $(OUTPUT_QUEUE_ENABLE)), yes)
+    DEFERRED_EXEC_ENABLE = yes
+    SRC += output_queue.c
+    OPT_DEFS += -DOUTPUT_QUEUE_ENABLE
+endif
+
+ifeq ($(strip $(TIMER_US_REQUIRED)), yes)
+    SRC += timer_us.c
+    OPT_DEFS += -DTIMER_US_ENABLE
+endif
@@ -0,0 +1,80 @@
+#include "seruman.h"
+
+#ifdef TRI_LAYER_STATE_ENABLE
+// Same defaults as QMK's TRI_LAYER_ENABLE.
+#    ifndef TRI_LAYER_LOWER_LAYER
+#        define TRI_LAYER_LOWER_LAYER 1
+#    endif
+#    ifndef TRI_LAYER_UPPER_LAYER
+#        define TRI_LAYER_UPPER_LAYER 2
+#    endif
+#    ifndef TRI_LAYER_ADJUST_LAYER
+#        define TRI_LAYER_ADJUST_LAYER 3
+#    endif
+#endif
+
+__attribute__((weak)) bool process_record_keymap(uint16_t keycode, keyrecord_t *record) {
+    return true;
+}
+
+__attribute__((weak)) layer_state_t layer_state_set_keymap(layer_state_t state) {
+    return state;
+}
+
+__attribute__((weak)) void keyboard_post_init_keymap(void) {}
+
+__attribute__((weak)) void housekeeping_task_keymap(void) {}
+
+#ifdef KEY_TRACE_ENABLE
+bool pre_process_record_user(uint16_t keycode, keyrecord_t *record) {
+    key_trace(KEY_TRACE_MATRIX, keycode, record);
+    return true;
+}
+
+void post_process_record_user(uint16_t keycode, keyrecord_t *record) {
+    key_trace(KEY_TRACE_SENT, keycode, record);
+}
+#endif
+
+bool process_record_user(uint16_t keycode, keyrecord_t *record) {
+    HOOK_TIMING_SCOPE(HOOK_PROCESS_RECORD);
+    key_trace(KEY_TRACE_RESOLVED, keycode, record);
+    adaptive_term_record(keycode, record);
+
+    return process_record_keymap(keycode, record);
+}
+
+layer_state_t layer_state_set_user(layer_state_t state) {
+    HOOK_TIMING_SCOPE(HOOK_LAYER_STATE_SET);
+
+#ifdef TRI_LAYER_STATE_ENABLE
+    state = update_tri_layer_state(state, TRI_LAYER_LOWER_LAYER, TRI_LAYER_UPPER_LAYER, TRI_LAYER_ADJUST_LAYER);
+#endif
+    return layer_state_set_keymap(state);
+}
+
+void keyboard_post_init_user(void) {
+    adaptive_term_init();
+    chordal_hold_init();
+    keyboard_post_init_keymap();
+}
+
+void housekeeping_task_user(void) {
+    timer_us_task();
+    hook_timing_task();
+    adaptive_term_task();
+    encoder_accel_task();
+    housekeeping_task_keymap();
+}
+
+#ifdef TAPPING_TERM_PER_KEY
+__attribute__((weak)) uint16_t get_tapping_term_keymap(uint16_t keycode, keyrecord_t *record) {
+    return TAPPING_TERM;
+}
+
+// The keymap's terms stay the baseline; learned ones only move within
+// ADAPTIVE_TERM_RANGE of them.
+uint16_t get_tapping_term(uint16_t keycode, keyrecord_t *record) {
+    return adaptive_term_get(keycode, get_tapping_term_keymap(keycode, record));
+}
+#endif
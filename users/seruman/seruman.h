@@ -0,0 +1,49 @@
+#pragma once
+
+#include QMK_KEYBOARD_H
+
+#include "adaptive_term.h"
+#include "chordal_hold.h"
+#include "encoder_accel.h"
+#include "hook_timing.h"
+#include "key_trace.h"
+#include "layer_dance.h"
+#include "output_queue.h"
+#include "timer_us.h"
+#ifdef RAW_ENABLE
+#    include "hid_protocol.h"
+#endif
+
+// Shared by the seruman keymaps. seruman.c owns the user hooks below and
+// wires up whichever library features the keymap's rules.mk enabled, then
+// calls the keymap's own variant. Keymaps define the weak *_keymap hooks
+// instead of the *_user ones:
+//
+//     bool          process_record_keymap(uint16_t keycode, keyrecord_t *record);
+//     layer_state_t layer_state_set_keymap(layer_state_t state);
+//     void          keyboard_post_init_keymap(void);
+//     void          housekeeping_task_keymap(void);
+//     uint16_t      get_tapping_term_keymap(uint16_t keycode, keyrecord_t *record);
+//
+// With TRI_LAYER_STATE_ENABLE = yes, TRI_LAYER_ADJUST_LAYER is on whenever
+// both TRI_LAYER_LOWER_LAYER and TRI_LAYER_UPPER_LAYER are, however they
+// were turned on. Boards that only reach them through TL_LOWR and TL_UPPR
+// use QMK's own TRI_LAYER_ENABLE instead.
+
+bool          process_record_keymap(uint16_t keycode, keyrecord_t *record);
+layer_state_t layer_state_set_keymap(layer_state_t state);
+void          keyboard_post_init_keymap(void);
+void          housekeeping_task_keymap(void);
+uint16_t      get_tapping_term_keymap(uint16_t keycode, keyrecord_t *record);
+
+// Mod-taps holding two modifiers.
+#define LGA_T(kc) MT(MOD_LGUI | MOD_LALT, kc)
+#define RGA_T(kc) MT(MOD_RGUI | MOD_RALT, kc)
+
+// Media keys, laid out the same on every board's media layer.
+#define ___MEDIA_VOLUME___ KC_VOLD, KC_MUTE, KC_VOLU
+#define ___MEDIA_TRACK____ KC_MPRV, KC_MPLY, KC_MNXT
+
+// Expands row macros such as ___MEDIA_VOLUME___ before `layout` counts its
+// arguments.
+#define WRAP(layout, ...) layout(__VA_ARGS__)
@@ -0,0 +1,68 @@
+#include QMK_KEYBOARD_H
+
+#include "timer_us.h"
+
+#if defined(PROTOCOL_CHIBIOS)
+#    include <ch.h>
+#elif defined(__AVR__)
+#    include <util/atomic.h>
+#    include "timer_avr.h"
+#endif
+
+#if defined(PROTOCOL_CHIBIOS)
+
+// The system timer may be 16 bits wide and tick slower than 1 MHz, so its
+// value cannot simply be converted. Each read adds the ticks since the
+// previous one instead, keeping what is left of a microsecond for the next.
+static systime_t last_ticks;
+static uint32_t  now_us;
+#    if CH_CFG_ST_FREQUENCY != 1000000
+static uint32_t remainder;
+#    endif
+
+uint32_t timer_read_us(void) {
+    systime_t     ticks   = chVTGetSystemTimeX();
+    sysinterval_t elapsed = chTimeDiffX(last_ticks, ticks);
+    last_ticks            = ticks;
+
+#    if CH_CFG_ST_FREQUENCY == 1000000
+    now_us += elapsed;
+#    else
+    uint64_t scaled = (uint64_t)elapsed * 1000000 + remainder;
+    now_us += (uint32_t)(scaled / CH_CFG_ST_FREQUENCY);
+    remainder = (uint32_t)(scaled % CH_CFG_ST_FREQUENCY);
+#    endif
+    return now_us;
+}
+
+void timer_us_task(void) {
+    timer_read_us();
+}
+
+#else
+
+uint32_t timer_read_us(void) {
+#    if defined(__AVR__)
+    // The millisecond timer plus its hardware counter, 4 us per tick at
+    // 16 MHz.
+    uint32_t ms;
+    uint8_t  raw;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        ms  = timer_read32();
+        raw = TIMER_RAW;
+        // The compare match that advances the millisecond count may still
+        // be pending.
+        if ((TIFR0 & _BV(OCF0A)) && raw < TIMER_RAW_TOP / 2) {
+            ms++;
+        }
+    }
+    return ms * 1000 + (uint32_t)raw * 1000 / TIMER_RAW_TOP;
+#    else
+    return timer_read32() * 1000;
+#    endif
+}
+
+// Derived from the 32-bit millisecond timer, which needs no help.
+void timer_us_task(void) {}
+
+#endif
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stdint.h>
+
+// Free-running microsecond timestamp, built whenever a feature needs it.
+// Every platform wraps it at 2^32 us, about 71.6 minutes, so subtracting
+// two of them gives the interval across a wrap.
+//
+// On ChibiOS it is extended from the system timer, which may be only 16
+// bits wide, so it has to be read at least once per timer period; seruman.c
+// calls timer_us_task from housekeeping for that.
+
+#ifdef TIMER_US_ENABLE
+
+uint32_t timer_read_us(void);
+
+// Call from housekeeping_task_user.
+void timer_us_task(void);
+
+#else
+
+#    define timer_us_task()
+
+#endif